@@ -1,32 +1,65 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
 static const char EMPTY_PAGE_DATA[PAGE_SIZE] = {0};
 
+static constexpr uint32_t WARM_UP_MAGIC = 0x4d535755;  // "MSWU"
+
 // constructor
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager) {
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size_);
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, ReplacerType replacer_type)
+    : pool_size_(pool_size),
+      chunk_frames_(max<size_t>(1, min<size_t>(pool_size, BUFFER_POOL_CHUNK_FRAMES))),
+      disk_manager_(disk_manager) {
+  while (chunks_.size() * chunk_frames_ < pool_size_) {
+    chunks_.push_back(new Page[chunk_frames_]);
+  }
+  switch (replacer_type) {
+    case ReplacerType::kLRUK:
+      replacer_ = new LRUKReplacer(pool_size_);
+      break;
+    case ReplacerType::kClock:
+      replacer_ = new ClockReplacer(pool_size_);
+      break;
+    case ReplacerType::kLRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+  }
   for (size_t i = 0; i < pool_size_; i++) {
     free_list_.emplace_back(i);
   }
+  files_.push_back(disk_manager_);
 }
 // destructor
 BufferPoolManager::~BufferPoolManager() {
+  StopPrefetcher();
+  StopBackgroundWriter();
   for (auto page : page_table_) {
-    FlushPage(page.first);
+    Page *frame = Frame(page.second);
+    if (Disk(frame->file_id_) != nullptr) {
+      FlushFilePage(frame->file_id_, frame->page_id_);
+    }
+  }
+  for (auto chunk : chunks_) {
+    delete[] chunk;
   }
-  delete[] pages_;
   delete replacer_;
 }
 
+Page *BufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return FetchFilePage(0, page_id, strategy);
+}
+
 /**
  * TODO: Student Implement
  */
-Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+Page *BufferPoolManager::FetchFilePage(file_id_t file_id, page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin fetch_page_it and return fetch_page_it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -36,155 +69,781 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
   if(page_id == INVALID_PAGE_ID)
     return nullptr;
-  auto fetch_page_it = page_table_.find(page_id);
+  page_key_t key = PageKey(file_id, page_id);
+  unique_lock<recursive_mutex> lock(latch_);
+  WaitForLoad(lock, key);
+  Count(counters_, &BufferPoolCounters::fetches_);
+  auto fetch_page_it = page_table_.find(key);
   if (fetch_page_it != page_table_.end()) {
+    Count(counters_, &BufferPoolCounters::hits_);
+    if (Frame(fetch_page_it->second)->pin_count_++ == 0) {
+      OnFramePinned();
+    }
     replacer_->Pin(fetch_page_it->second);
-    return &pages_[fetch_page_it->second];
+    return Frame(fetch_page_it->second);
+  }
+  Count(counters_, &BufferPoolCounters::misses_);
+  frame_id_t cache_page_frame_id = AcquireFrame(strategy);
+  if (cache_page_frame_id == INVALID_FRAME_ID) {
+    return nullptr;
+  }
+  Page *cache_page = Frame(cache_page_frame_id);
+  bool read;
+  if (cache_page->page_id_ != INVALID_PAGE_ID && cache_page->IsDirty()) {
+    bool written;
+    read = ReplaceDirtyFrame(cache_page, file_id, page_id, written);
+    if (!written) {
+      RestoreVictim(cache_page_frame_id);
+      return nullptr;
+    }
   } else {
-    frame_id_t cache_page_frame_id;
-    Page *cache_page = nullptr;
-    if (!free_list_.empty()) {
-      auto free_it = free_list_.begin();
-      cache_page_frame_id = *free_it;
-      cache_page = &pages_[cache_page_frame_id];
-      free_list_.erase(free_it);
-    } else {
-      if (replacer_->UnpinSize() > 0) {
-        replacer_->Victim(&cache_page_frame_id);
-        cache_page = &pages_[cache_page_frame_id];
-        if (cache_page->IsDirty()) {
-          disk_manager_->WritePage(cache_page->page_id_, cache_page->data_);
-        }
-        page_table_.erase(cache_page->page_id_);
-      } else
-        return nullptr;
-    }
-    page_table_.emplace(page_id, cache_page_frame_id);
-    disk_manager_->ReadPage(page_id, pages_[cache_page_frame_id].data_);
-    pages_[cache_page_frame_id].page_id_ = page_id;
-    pages_[cache_page_frame_id].is_dirty_ = false;
-    if (pages_[cache_page_frame_id].pin_count_++ == 0) {
-      replacer_->Pin(cache_page_frame_id);
-    }
-    return &pages_[cache_page_frame_id];
-  }
-  // return nullptr;
+    read = Disk(file_id)->ReadPage(page_id, cache_page->data_);
+  }
+  if (!read) {
+    // whatever landed in the frame is not the page
+    DiscardFrame(cache_page_frame_id);
+    return nullptr;
+  }
+  page_table_.emplace(key, cache_page_frame_id);
+  cache_page->page_id_ = page_id;
+  cache_page->file_id_ = file_id;
+  cache_page->is_dirty_ = false;
+  if (cache_page->pin_count_++ == 0) {
+    OnFramePinned();
+    replacer_->Pin(cache_page_frame_id);
+  }
+  return cache_page;
 }
 
+Page *BufferPoolManager::NewPage(page_id_t &page_id) { return NewFilePage(0, page_id); }
+
 /**
  * TODO: Student Implement
  */
-Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+Page *BufferPoolManager::NewFilePage(file_id_t file_id, page_id_t &page_id) {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  frame_id_t cache_page_frame_id;
-  Page *cache_page = nullptr;
+  scoped_lock<recursive_mutex> lock(latch_);
+  frame_id_t cache_page_frame_id = TryToFindFreePage();
+  if (cache_page_frame_id == INVALID_FRAME_ID) {
+    Count(counters_, &BufferPoolCounters::new_page_failures_);
+    return nullptr;
+  }
+  page_id = AllocatePage(file_id);
+  Page *page = InstallNewPage(cache_page_frame_id, file_id, page_id);
+  if (page == nullptr) {
+    Count(counters_, &BufferPoolCounters::new_page_failures_);
+    DeallocatePage(file_id, page_id);
+  }
+  return page;
+}
+
+Page *BufferPoolManager::NewFilePageWithId(file_id_t file_id, page_id_t page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  frame_id_t cache_page_frame_id = TryToFindFreePage();
+  if (cache_page_frame_id == INVALID_FRAME_ID) {
+    Count(counters_, &BufferPoolCounters::new_page_failures_);
+    return nullptr;
+  }
+  return InstallNewPage(cache_page_frame_id, file_id, page_id);
+}
+
+Page *BufferPoolManager::InstallNewPage(frame_id_t frame_id, file_id_t file_id, page_id_t page_id) {
+  Page *cache_page = Frame(frame_id);
+  if (cache_page->page_id_ != INVALID_PAGE_ID && cache_page->IsDirty() && !WriteBackVictim(frame_id)) {
+    return nullptr;
+  }
+  page_table_.emplace(PageKey(file_id, page_id), frame_id);
+  cache_page->ResetMemory();
+  cache_page->page_id_ = page_id;
+  cache_page->file_id_ = file_id;
+  cache_page->is_dirty_ = false;
+  cache_page->pin_count_ = 1;
+  OnFramePinned();
+  replacer_->Pin(frame_id);
+  return cache_page;
+}
+
+frame_id_t BufferPoolManager::TryToFindFreePage() {
+  frame_id_t frame_id = INVALID_FRAME_ID;
   if (!free_list_.empty()) {
-    auto free_it = free_list_.begin();
-    cache_page_frame_id = *free_it;
-    cache_page = &pages_[cache_page_frame_id];
-    free_list_.erase(free_it);
-  } else {
-    if (replacer_->UnpinSize() > 0) {
-      replacer_->Victim(&cache_page_frame_id);
-      cache_page = &pages_[cache_page_frame_id];
-      page_table_.erase(cache_page->page_id_);
-    } else
-      return nullptr;
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+    return frame_id;
+  }
+  if (replacer_->UnpinSize() > 0 && replacer_->Victim(&frame_id)) {
+    Count(counters_, &BufferPoolCounters::evictions_);
+    RemoveFromPageTable(FrameKey(Frame(frame_id)));
+    return frame_id;
+  }
+  return INVALID_FRAME_ID;
+}
+
+frame_id_t BufferPoolManager::TryToReuseRingFrame(BufferAccessStrategy *strategy) {
+  Page *frame = strategy->Current();
+  // the ring may still point at a frame the pool has been shrunk past
+  frame_id_t frame_id = FrameIdOf(frame);
+  if (frame_id == INVALID_FRAME_ID) {
+    return INVALID_FRAME_ID;
+  }
+  // a free frame sits in the free list, a pinned one is in use and a loading one is not filled yet, leave them alone
+  if (frame->page_id_ == INVALID_PAGE_ID || frame->pin_count_ > 0 || loading_pages_.count(FrameKey(frame)) > 0) {
+    return INVALID_FRAME_ID;
+  }
+  Count(counters_, &BufferPoolCounters::evictions_);
+  replacer_->Remove(frame_id);
+  RemoveFromPageTable(FrameKey(frame));
+  return frame_id;
+}
+
+frame_id_t BufferPoolManager::FrameIdOf(const Page *frame) const {
+  if (frame == nullptr) {
+    return INVALID_FRAME_ID;
+  }
+  for (size_t i = 0; i < chunks_.size(); i++) {
+    if (frame >= chunks_[i] && frame < chunks_[i] + chunk_frames_) {
+      size_t frame_id = i * chunk_frames_ + (frame - chunks_[i]);
+      return frame_id < pool_size_ ? static_cast<frame_id_t>(frame_id) : INVALID_FRAME_ID;
+    }
+  }
+  return INVALID_FRAME_ID;
+}
+
+frame_id_t BufferPoolManager::AcquireFrame(BufferAccessStrategy *strategy) {
+  frame_id_t frame_id = strategy == nullptr ? INVALID_FRAME_ID : TryToReuseRingFrame(strategy);
+  if (frame_id == INVALID_FRAME_ID) {
+    frame_id = TryToFindFreePage();
+  }
+  if (frame_id != INVALID_FRAME_ID && strategy != nullptr) {
+    strategy->Remember(Frame(frame_id));
   }
-  page_id_t new_page_id = AllocatePage();
-  page_table_.emplace(new_page_id, cache_page_frame_id);
-  pages_[cache_page_frame_id].ResetMemory();
-  pages_[cache_page_frame_id].page_id_ = new_page_id;
-  page_id = new_page_id;
-  pages_[cache_page_frame_id].is_dirty_ = false;
-  pages_[cache_page_frame_id].pin_count_ = 1;
-  replacer_->Pin(cache_page_frame_id);
-  return &pages_[cache_page_frame_id];
-  // return nullptr;
+  return frame_id;
 }
 
+bool BufferPoolManager::DeletePage(page_id_t page_id) { return DeleteFilePage(0, page_id); }
+
 /**
  * TODO: Student Implement
  */
-bool BufferPoolManager::DeletePage(page_id_t page_id) {
+bool BufferPoolManager::DeleteFilePage(file_id_t file_id, page_id_t page_id) {
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-  auto it = page_table_.find(page_id);
-  if (it == page_table_.end())
+  page_key_t key = PageKey(file_id, page_id);
+  unique_lock<recursive_mutex> lock(latch_);
+  WaitForLoad(lock, key);
+  auto it = page_table_.find(key);
+  if (it == page_table_.end()) {
+    DeallocatePage(file_id, page_id);
     return true;
-  else if (pages_[it->second].pin_count_ > 0)
+  } else if (Frame(it->second)->pin_count_ > 0)
     return false;
   frame_id_t cache_page_frame_id = it->second;
-  Page *cache_page = &pages_[cache_page_frame_id];
+  Page *cache_page = Frame(cache_page_frame_id);
   if (cache_page->IsDirty()) {
-    FlushPage(page_id);
+    FlushFilePage(file_id, page_id);
   }
-  page_table_.erase(page_id);
+  RemoveFromPageTable(key);
   cache_page->page_id_ = INVALID_PAGE_ID;
   cache_page->pin_count_ = 0;
   cache_page->is_dirty_ = false;
-  free_list_.push_back(it->second);
-  DeallocatePage(page_id);
+  // the frame goes back to the free list, so the replacer must forget it
+  replacer_->Remove(cache_page_frame_id);
+  free_list_.push_back(cache_page_frame_id);
+  DeallocatePage(file_id, page_id);
   return true;
 }
 
+bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) { return UnpinFilePage(0, page_id, is_dirty); }
+
 /**
  * TODO: Student Implement
  */
-bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
-  auto it = page_table_.find(page_id);
+bool BufferPoolManager::UnpinFilePage(file_id_t file_id, page_id_t page_id, bool is_dirty) {
+  page_key_t key = PageKey(file_id, page_id);
+  scoped_lock<recursive_mutex> lock(latch_);
+  auto it = page_table_.find(key);
   if (it == page_table_.end()) {
     return true;
   }
   frame_id_t cache_page_frame_id = it->second;
-  Page *cache_page = &pages_[cache_page_frame_id];
+  Page *cache_page = Frame(cache_page_frame_id);
   if (cache_page->pin_count_ > 0) {
     cache_page->pin_count_--;
     if (is_dirty) {
       cache_page->is_dirty_ = true;
+      dirty_pages_.insert(key);
     }
     if (cache_page->pin_count_ == 0) {
+      pinned_frames_--;
       replacer_->Unpin(cache_page_frame_id);
     }
   }
   return true;
 }
 
+bool BufferPoolManager::FlushPage(page_id_t page_id) { return FlushFilePage(0, page_id); }
+
 /**
  * TODO: Student Implement
  */
-bool BufferPoolManager::FlushPage(page_id_t page_id) {
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) disk_manager_->WritePage(page_id, pages_[it->second].data_);
+bool BufferPoolManager::FlushFilePage(file_id_t file_id, page_id_t page_id) {
+  page_key_t key = PageKey(file_id, page_id);
+  unique_lock<recursive_mutex> lock(latch_);
+  WaitForLoad(lock, key);
+  auto it = page_table_.find(key);
+  if (it != page_table_.end()) {
+    // a page that could not be written stays dirty
+    if (!Disk(file_id)->WritePage(page_id, Frame(it->second)->data_)) {
+      return false;
+    }
+    Frame(it->second)->is_dirty_ = false;
+    dirty_pages_.erase(key);
+  }
   return true;
 }
 
-page_id_t BufferPoolManager::AllocatePage() {
-  int next_page_id = disk_manager_->AllocatePage();
+void BufferPoolManager::RemoveFromPageTable(page_key_t key) {
+  page_table_.erase(key);
+  dirty_pages_.erase(key);
+}
+
+bool BufferPoolManager::ReplaceDirtyFrame(Page *frame, file_id_t file_id, page_id_t new_page_id, bool &written) {
+  eviction_writes_++;
+  Count(counters_, &BufferPoolCounters::dirty_writes_);
+  DiskManager *victim_disk = Disk(frame->file_id_);
+  DiskManager *disk = Disk(file_id);
+  // both requests can only go out as one batch when they are for the same file
+  if (!disk->IsAsyncIOEnabled() || victim_disk != disk) {
+    written = victim_disk->WritePage(frame->page_id_, frame->data_);
+    return written && disk->ReadPage(new_page_id, frame->data_);
+  }
+  // write the old image from a copy so that the read of the new page can land in the frame at the same time
+  char victim_data[PAGE_SIZE];
+  memcpy(victim_data, frame->data_, PAGE_SIZE);
+  std::vector<DiskRequest> requests(2);
+  requests[0].is_write_ = true;
+  requests[0].page_id_ = frame->page_id_;
+  requests[0].data_ = victim_data;
+  requests[1].is_write_ = false;
+  requests[1].page_id_ = new_page_id;
+  requests[1].data_ = frame->data_;
+  auto write_done = requests[0].done_.get_future();
+  auto read_done = requests[1].done_.get_future();
+  disk->SubmitRequests(requests);
+  written = write_done.get();
+  bool read = read_done.get();
+  if (!written) {
+    // the old page stays, it is the only copy of its changes
+    memcpy(frame->data_, victim_data, PAGE_SIZE);
+  }
+  return read;
+}
+
+bool BufferPoolManager::WriteBackVictim(frame_id_t frame_id) {
+  Page *frame = Frame(frame_id);
+  eviction_writes_++;
+  Count(counters_, &BufferPoolCounters::dirty_writes_);
+  if (Disk(frame->file_id_)->WritePage(frame->page_id_, frame->data_)) {
+    return true;
+  }
+  RestoreVictim(frame_id);
+  return false;
+}
+
+void BufferPoolManager::RestoreVictim(frame_id_t frame_id) {
+  page_key_t key = FrameKey(Frame(frame_id));
+  page_table_.emplace(key, frame_id);
+  dirty_pages_.insert(key);
+  replacer_->Unpin(frame_id);
+}
+
+void BufferPoolManager::DiscardFrame(frame_id_t frame_id) {
+  Page *frame = Frame(frame_id);
+  frame->page_id_ = INVALID_PAGE_ID;
+  frame->pin_count_ = 0;
+  frame->is_dirty_ = false;
+  replacer_->Remove(frame_id);
+  free_list_.push_back(frame_id);
+}
+
+page_id_t BufferPoolManager::AllocatePage(file_id_t file_id) {
+  int next_page_id = Disk(file_id)->AllocatePage();
   return next_page_id;
 }
 
-void BufferPoolManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-  disk_manager_->DeAllocatePage(page_id);
+void BufferPoolManager::DeallocatePage(file_id_t file_id, page_id_t page_id) {
+  Disk(file_id)->DeAllocatePage(page_id);
 }
 
 bool BufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->IsPageFree(page_id); }
 
+size_t BufferPoolManager::ResizePool(size_t pool_size) {
+  if (pool_size == 0) {
+    LOG(WARNING) << "a buffer pool needs at least one frame";
+    pool_size = 1;
+  }
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    if (pool_size >= pool_size_) {
+      while (chunks_.size() * chunk_frames_ < pool_size) {
+        chunks_.push_back(new Page[chunk_frames_]);
+      }
+      replacer_->Resize(pool_size);
+      for (size_t i = pool_size_; i < pool_size; i++) {
+        free_list_.emplace_back(i);
+      }
+      pool_size_ = pool_size;
+      return pool_size_;
+    }
+  }
+  // shrink one chunk at a time, the latch is given up in between so requests are not held up by the whole shrink
+  while (true) {
+    scoped_lock<recursive_mutex> lock(latch_);
+    if (pool_size_ <= pool_size) {
+      break;
+    }
+    size_t step_target = max(pool_size, pool_size_ > chunk_frames_ ? pool_size_ - chunk_frames_ : 0);
+    size_t new_size = pool_size_;
+    while (new_size > step_target && ReleaseFrame(static_cast<frame_id_t>(new_size - 1))) {
+      new_size--;
+    }
+    free_list_.remove_if([new_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_size; });
+    replacer_->Resize(new_size);
+    pool_size_ = new_size;
+    while ((chunks_.size() - 1) * chunk_frames_ >= pool_size_) {
+      delete[] chunks_.back();
+      chunks_.pop_back();
+    }
+    if (new_size > step_target) {
+      LOG(WARNING) << "buffer pool shrink stopped at " << pool_size_ << " frames, frame " << new_size - 1
+                   << " is in use";
+      break;
+    }
+  }
+  return pool_size_;
+}
+
+bool BufferPoolManager::ReleaseFrame(frame_id_t frame_id) {
+  Page *frame = Frame(frame_id);
+  if (frame->page_id_ == INVALID_PAGE_ID) {
+    return true;
+  }
+  if (frame->pin_count_ > 0 || loading_pages_.count(FrameKey(frame)) > 0) {
+    return false;
+  }
+  if (frame->IsDirty()) {
+    eviction_writes_++;
+    Count(counters_, &BufferPoolCounters::dirty_writes_);
+    if (!Disk(frame->file_id_)->WritePage(frame->page_id_, frame->data_)) {
+      return false;
+    }
+  }
+  Count(counters_, &BufferPoolCounters::evictions_);
+  RemoveFromPageTable(FrameKey(frame));
+  frame->page_id_ = INVALID_PAGE_ID;
+  frame->is_dirty_ = false;
+  return true;
+}
+
 // check unpin
 bool BufferPoolManager::CheckAllUnpinned() {
+  scoped_lock<recursive_mutex> lock(latch_);
+  bool res = true;
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (Frame(i)->pin_count_ != 0) {
+      res = false;
+      LOG(ERROR) << "page " << Frame(i)->page_id_ << " pin count:" << Frame(i)->pin_count_ << endl;
+    }
+  }
+  return res;
+}
+
+bool BufferPoolManager::CheckFileUnpinned(file_id_t file_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
   bool res = true;
   for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].pin_count_ != 0) {
+    if (Frame(i)->page_id_ != INVALID_PAGE_ID && Frame(i)->file_id_ == file_id && Frame(i)->pin_count_ != 0) {
       res = false;
-      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
+      LOG(ERROR) << "page " << Frame(i)->page_id_ << " pin count:" << Frame(i)->pin_count_ << endl;
     }
   }
   return res;
-}
\ No newline at end of file
+}
+
+vector<page_id_t> BufferPoolManager::GetHotPages() { return GetFileHotPages(0); }
+
+vector<page_id_t> BufferPoolManager::GetFileHotPages(file_id_t file_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  vector<page_id_t> page_ids;
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *frame = Frame(i);
+    if (frame->page_id_ != INVALID_PAGE_ID && frame->file_id_ == file_id && frame->pin_count_ > 0) {
+      page_ids.push_back(frame->page_id_);
+    }
+  }
+  for (auto frame_id : replacer_->HotFrames()) {
+    Page *frame = Frame(frame_id);
+    if (frame->page_id_ != INVALID_PAGE_ID && frame->file_id_ == file_id) {
+      page_ids.push_back(frame->page_id_);
+    }
+  }
+  return page_ids;
+}
+
+file_id_t BufferPoolManager::AttachFile(DiskManager *disk_manager) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  for (file_id_t file_id = 1; file_id < files_.size(); file_id++) {
+    if (files_[file_id] == nullptr) {
+      files_[file_id] = disk_manager;
+      return file_id;
+    }
+  }
+  files_.push_back(disk_manager);
+  return static_cast<file_id_t>(files_.size() - 1);
+}
+
+void BufferPoolManager::DetachFile(file_id_t file_id) {
+  unique_lock<recursive_mutex> lock(latch_);
+  for (size_t i = 0; i < pool_size_; i++) {
+    Page *frame = Frame(i);
+    if (frame->page_id_ == INVALID_PAGE_ID || frame->file_id_ != file_id) {
+      continue;
+    }
+    page_key_t key = FrameKey(frame);
+    WaitForLoad(lock, key);
+    if (frame->pin_count_ > 0) {
+      LOG(ERROR) << "page " << frame->page_id_ << " is still pinned when its file leaves the buffer pool";
+      pinned_frames_--;
+    }
+    if (frame->IsDirty() && !Disk(file_id)->WritePage(frame->page_id_, frame->data_)) {
+      LOG(ERROR) << "changes to page " << frame->page_id_ << " are lost, its file leaves the buffer pool";
+    }
+    RemoveFromPageTable(key);
+    frame->page_id_ = INVALID_PAGE_ID;
+    frame->pin_count_ = 0;
+    frame->is_dirty_ = false;
+    replacer_->Remove(static_cast<frame_id_t>(i));
+    free_list_.push_back(static_cast<frame_id_t>(i));
+  }
+  files_[file_id] = nullptr;
+}
+
+bool BufferPoolManager::SaveWarmUpList(const string &path) {
+  vector<page_id_t> page_ids = GetHotPages();
+  ofstream out(path, ios::binary | ios::trunc);
+  if (!out.is_open()) {
+    LOG(WARNING) << "cannot write buffer pool warm-up list " << path;
+    return false;
+  }
+  uint32_t header[2] = {WARM_UP_MAGIC, static_cast<uint32_t>(page_ids.size())};
+  out.write(reinterpret_cast<const char *>(header), sizeof(header));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+  return out.good();
+}
+
+size_t BufferPoolManager::StartWarmUp(const string &path) {
+  vector<page_id_t> page_ids;
+  {
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+      return 0;
+    }
+    in.seekg(0, ios::end);
+    auto file_size = static_cast<size_t>(max<streamoff>(0, in.tellg()));
+    in.seekg(0, ios::beg);
+    uint32_t header[2] = {0, 0};
+    in.read(reinterpret_cast<char *>(header), sizeof(header));
+    // the count is only trusted if the file holds exactly that many page ids
+    if (!in || header[0] != WARM_UP_MAGIC ||
+        file_size != sizeof(header) + static_cast<size_t>(header[1]) * sizeof(page_id_t)) {
+      LOG(WARNING) << "ignoring malformed buffer pool warm-up list " << path;
+      header[1] = 0;
+    }
+    // the list is hottest first, keep what fits
+    page_ids.resize(min<size_t>(header[1], GetPoolSize()));
+    in.read(reinterpret_cast<char *>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+    if (!in) {
+      page_ids.clear();
+    }
+  }
+  remove(path.c_str());
+  // read the pages in file order
+  sort(page_ids.begin(), page_ids.end());
+  size_t queued = 0;
+  for (auto page_id : page_ids) {
+    // pages deleted since the list was saved are skipped
+    if (page_id != INVALID_PAGE_ID && !IsPageFree(page_id)) {
+      PrefetchPage(page_id);
+      queued++;
+    }
+  }
+  return queued;
+}
+
+void BufferPoolManager::StartBackgroundWriter(size_t clean_target, size_t max_writes_per_round, uint32_t interval_ms) {
+  StopBackgroundWriter();
+  bgwriter_clean_target_ = clean_target;
+  bgwriter_max_writes_ = max_writes_per_round;
+  bgwriter_interval_ms_ = interval_ms;
+  bgwriter_stop_ = false;
+  bgwriter_ = thread(&BufferPoolManager::BackgroundWriterLoop, this);
+}
+
+void BufferPoolManager::StopBackgroundWriter() {
+  if (!bgwriter_.joinable()) {
+    return;
+  }
+  {
+    scoped_lock<mutex> lock(bgwriter_latch_);
+    bgwriter_stop_ = true;
+  }
+  bgwriter_cv_.notify_all();
+  bgwriter_.join();
+}
+
+BufferPoolWriteStats BufferPoolManager::GetWriteStats() {
+  BufferPoolWriteStats stats;
+  stats.background_writes_ = background_writes_.load();
+  stats.eviction_writes_ = eviction_writes_.load();
+  return stats;
+}
+
+BufferPoolStats BufferPoolManager::GetStats() {
+  BufferPoolStats stats(counters_);
+  scoped_lock<recursive_mutex> lock(latch_);
+  stats.pinned_frames_ = pinned_frames_;
+  stats.pinned_high_water_ = pinned_high_water_;
+  return stats;
+}
+
+void BufferPoolManager::ResetStats() {
+  counters_.Reset();
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    pinned_high_water_ = pinned_frames_;
+  }
+  scoped_lock<mutex> lock(owner_latch_);
+  for (auto &owner : owner_counters_) {
+    owner.second->Reset();
+  }
+}
+
+BufferPoolCounters *BufferPoolManager::GetOwnerCounters(const string &owner) {
+  scoped_lock<mutex> lock(owner_latch_);
+  auto &counters = owner_counters_[owner];
+  if (counters == nullptr) {
+    counters = make_unique<BufferPoolCounters>();
+  }
+  return counters.get();
+}
+
+map<string, BufferPoolStats> BufferPoolManager::GetOwnerStats() {
+  scoped_lock<mutex> lock(owner_latch_);
+  map<string, BufferPoolStats> stats;
+  for (auto &owner : owner_counters_) {
+    stats.emplace(owner.first, BufferPoolStats(*owner.second));
+  }
+  return stats;
+}
+
+void BufferPoolManager::BackgroundWriterLoop() {
+  unique_lock<mutex> lock(bgwriter_latch_);
+  while (!bgwriter_stop_) {
+    lock.unlock();
+    BackgroundWriterRound();
+    lock.lock();
+    bgwriter_cv_.wait_for(lock, chrono::milliseconds(bgwriter_interval_ms_), [this] { return bgwriter_stop_; });
+  }
+}
+
+size_t BufferPoolManager::BackgroundWriterRound() {
+  // a dirty page must be resident, one that is not is left alone rather than written from whatever frame
+  auto unpinned_frame = [this](page_key_t key) -> Page * {
+    auto it = page_table_.find(key);
+    ASSERT(it != page_table_.end(), "Dirty page missing from the page table.");
+    if (it == page_table_.end() || Frame(it->second)->pin_count_ > 0) {
+      return nullptr;
+    }
+    return Frame(it->second);
+  };
+  size_t budget;
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    size_t dirty_unpinned = 0;
+    for (auto key : dirty_pages_) {
+      if (unpinned_frame(key) != nullptr) {
+        dirty_unpinned++;
+      }
+    }
+    size_t clean_ready = free_list_.size() + replacer_->UnpinSize() - min(dirty_unpinned, replacer_->UnpinSize());
+    if (clean_ready >= bgwriter_clean_target_ || dirty_unpinned == 0) {
+      return 0;
+    }
+    budget = min({bgwriter_clean_target_ - clean_ready, bgwriter_max_writes_, dirty_unpinned});
+  }
+  size_t written = 0;
+  while (written < budget) {
+    // take the latch per page so foreground requests are never held up by more than one write
+    scoped_lock<recursive_mutex> lock(latch_);
+    auto it = dirty_pages_.lower_bound(bgwriter_cursor_);
+    Page *page = nullptr;
+    size_t checked = 0;
+    for (; checked < dirty_pages_.size(); checked++, it++) {
+      if (it == dirty_pages_.end()) {
+        it = dirty_pages_.begin();
+      }
+      page = unpinned_frame(*it);
+      if (page != nullptr) {
+        break;
+      }
+    }
+    if (page == nullptr) {
+      break;
+    }
+    page_key_t key = *it;
+    bgwriter_cursor_ = key + 1;
+    if (!Disk(page->file_id_)->WritePage(page->page_id_, page->data_)) {
+      // the page stays dirty, the next round tries again
+      break;
+    }
+    page->is_dirty_ = false;
+    dirty_pages_.erase(it);
+    background_writes_++;
+    written++;
+  }
+  return written;
+}
+
+BasicPageGuard BufferPoolManager::FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return BasicPageGuard(this, FetchPage(page_id, strategy));
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return ReadPageGuard(FetchPageBasic(page_id, strategy));
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return WritePageGuard(FetchPageBasic(page_id, strategy));
+}
+
+WritePageGuard BufferPoolManager::NewPageGuarded(page_id_t &page_id) {
+  WritePageGuard guard(BasicPageGuard(this, NewPage(page_id)));
+  guard.MarkDirty();
+  return guard;
+}
+
+void BufferPoolManager::PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  PrefetchFilePage(0, page_id, strategy);
+}
+
+void BufferPoolManager::PrefetchFilePage(file_id_t file_id, page_id_t page_id, BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  page_key_t key = PageKey(file_id, page_id);
+  scoped_lock<recursive_mutex> lock(latch_);
+  if (page_table_.count(key) > 0) {
+    return;
+  }
+  frame_id_t frame_id = AcquireFrame(strategy);
+  if (frame_id == INVALID_FRAME_ID) {
+    return;
+  }
+  Page *frame = Frame(frame_id);
+  // the old image has to be on disk before the page can be read again
+  if (frame->page_id_ != INVALID_PAGE_ID && frame->IsDirty() && !WriteBackVictim(frame_id)) {
+    return;
+  }
+  page_table_.emplace(key, frame_id);
+  frame->page_id_ = page_id;
+  frame->file_id_ = file_id;
+  frame->is_dirty_ = false;
+  frame->pin_count_ = 0;
+  // keep the frame away from the replacer until the read has landed, the page's history starts with its first use
+  replacer_->Remove(frame_id);
+  loading_pages_.insert(key);
+  prefetch_queue_.emplace_back(key, frame_id);
+  if (!prefetcher_.joinable()) {
+    prefetch_stop_ = false;
+    prefetcher_ = thread(&BufferPoolManager::PrefetchLoop, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchRange(page_id_t first_page_id, size_t count, BufferAccessStrategy *strategy) {
+  for (size_t i = 0; i < count; i++) {
+    PrefetchPage(first_page_id + static_cast<page_id_t>(i), strategy);
+  }
+}
+
+bool BufferPoolManager::IsPageLoading(page_id_t page_id) { return IsFilePageLoading(0, page_id); }
+
+bool BufferPoolManager::IsFilePageLoading(file_id_t file_id, page_id_t page_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  return loading_pages_.count(PageKey(file_id, page_id)) > 0;
+}
+
+void BufferPoolManager::WaitForLoad(unique_lock<recursive_mutex> &lock, page_key_t key) {
+  load_cv_.wait(lock, [this, key] { return loading_pages_.count(key) == 0; });
+}
+
+void BufferPoolManager::PrefetchLoop() {
+  unique_lock<recursive_mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_queue_.empty()) {
+      return;
+    }
+    // hand everything queued so far to the disk managers, one batch per file
+    vector<pair<page_key_t, frame_id_t>> batch(prefetch_queue_.begin(), prefetch_queue_.end());
+    prefetch_queue_.clear();
+    map<DiskManager *, vector<DiskRequest>> requests;
+    vector<future<bool>> reads;
+    for (auto &queued : batch) {
+      Page *frame = Frame(queued.second);
+      auto &request = requests[Disk(frame->file_id_)].emplace_back();
+      request.page_id_ = frame->page_id_;
+      request.data_ = frame->data_;
+      reads.push_back(request.done_.get_future());
+    }
+    lock.unlock();
+    for (auto &file_requests : requests) {
+      file_requests.first->SubmitRequests(file_requests.second);
+    }
+    vector<bool> read_ok;
+    for (auto &read : reads) {
+      read_ok.push_back(read.get());
+    }
+    lock.lock();
+    for (size_t i = 0; i < batch.size(); i++) {
+      auto &loaded = batch[i];
+      loading_pages_.erase(loaded.first);
+      if (!read_ok[i]) {
+        // nobody gets to see the frame, a fetch waiting for the page reads it itself
+        RemoveFromPageTable(loaded.first);
+        DiscardFrame(loaded.second);
+      } else if (Frame(loaded.second)->pin_count_ == 0) {
+        replacer_->Unpin(loaded.second);
+      }
+    }
+    load_cv_.notify_all();
+  }
+}
+
+void BufferPoolManager::StopPrefetcher() {
+  if (!prefetcher_.joinable()) {
+    return;
+  }
+  {
+    scoped_lock<recursive_mutex> lock(latch_);
+    prefetch_stop_ = true;
+  }
+  prefetch_cv_.notify_all();
+  prefetcher_.join();
+}
@@ -5,66 +5,48 @@
  * @param num_pages the maximum number of pages the ClockReplacer will be required to store
  */
 ClockReplacer::ClockReplacer(size_t num_pages)
-    :second_chance(num_pages,State::EMPTY),
-      pointer(0),
-      capacity(num_pages) {}
+    : reference_bits_((num_pages + 63) / 64, 0),
+      evictable_bits_((num_pages + 63) / 64, 0),
+      pinned_bits_((num_pages + 63) / 64, 0),
+      capacity_(num_pages) {}
 
 // dtor
-ClockReplacer::~ClockReplacer() {
-  //do nothing
-}
+ClockReplacer::~ClockReplacer() = default;
 
 /**
- * @brief find the first victim
+ * @brief sweep the hand until an evictable frame without the reference bit is found
  * @param frame_id
  * @return if there is a victim, return true, otherwise false
  */
 bool ClockReplacer::Victim(frame_id_t *frame_id) {
-  size_t count_nonempty = 0;
-  frame_id_t frame_id_victim = 0;
-
-  for (size_t i = 0; i < capacity; i++) { // traverse the whole clock
-    auto id_check = (pointer + i) % capacity;
-    switch (second_chance[id_check]) {
-      case State::EMPTY:
-        continue; // if empty, continue to next iteration
-      case State::UNUSED:
-        count_nonempty++;
-        // get the first victim
-        frame_id_victim = (frame_id_victim != 0) ? frame_id_victim : id_check;
-        break;
-      case State::ACCESSED:
-        count_nonempty++;
-        second_chance[id_check] = State::UNUSED; // if accessed, set to unused
-        break;
-    }
-  }
-
-  // now we have count_nonempty, frame_id_victim ready
-
-  // all empty, return false
-  if (count_nonempty == 0) {
+  if (evictable_size_ == 0) {
     *frame_id = INVALID_FRAME_ID;
     return false;
   }
-
-  // if no victim, get the first victim
-  if (frame_id_victim == 0) {
-    for (size_t i = 0; i < capacity; i++) {
-      auto id_check = (pointer + i) % capacity;
-      if (second_chance[id_check] == State::UNUSED) {
-        frame_id_victim = id_check;
-        break;
+  // every evictable frame loses its reference bit during the first sweep, so at most two sweeps are needed
+  while (true) {
+    uint64_t word = evictable_bits_[hand_ >> 6] >> (hand_ & 63);
+    if (word == 0) {
+      // nothing evictable in the rest of this word
+      hand_ = (hand_ | 63) + 1;
+      if (hand_ >= capacity_) {
+        hand_ = 0;
       }
+      continue;
+    }
+    // jump straight to the next evictable frame of this word
+    hand_ += __builtin_ctzll(word);
+    if (TestBit(reference_bits_, hand_)) {
+      ClearBit(reference_bits_, hand_);
+      Advance();
+      continue;
     }
+    *frame_id = static_cast<frame_id_t>(hand_);
+    ClearBit(evictable_bits_, hand_);
+    evictable_size_--;
+    Advance();
+    return true;
   }
-
-  // set the victim to empty
-  second_chance[frame_id_victim] = State::EMPTY;
-  pointer = frame_id_victim;
-  *frame_id = frame_id_victim;
-
-  return true;
 }
 
 /*
@@ -72,35 +54,100 @@ bool ClockReplacer::Victim(frame_id_t *frame_id) {
  * @brief pin the frame_id
  * @param frame_id
  * @return void
- *  By setting the frame_id to EMPTY, we can make sure that the frame_id will not be chosen as victim
+ *  By clearing the evictable bit, we can make sure that the frame_id will not be chosen as victim
  */
 void ClockReplacer::Pin(frame_id_t frame_id) {
-  //remove from replacer
-  second_chance[frame_id % capacity] = State::EMPTY;
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= capacity_) {
+    return;
+  }
+  if (TestBit(evictable_bits_, frame_id)) {
+    ClearBit(evictable_bits_, frame_id);
+    evictable_size_--;
+  }
+  if (!TestBit(pinned_bits_, frame_id)) {
+    SetBit(pinned_bits_, frame_id);
+    pinned_size_++;
+  }
 }
 
 /*
- *  By setting the frame_id to ACCESSED, we can make sure that the frame_id can be chosen as victim
+ *  By setting the evictable and reference bits, the frame_id can be chosen as victim after a second chance
  */
 void ClockReplacer::Unpin(frame_id_t frame_id) {
-  //add into replacer
-  second_chance[frame_id % capacity] = State::ACCESSED;
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= capacity_) {
+    return;
+  }
+  if (TestBit(pinned_bits_, frame_id)) {
+    ClearBit(pinned_bits_, frame_id);
+    pinned_size_--;
+  }
+  SetBit(reference_bits_, frame_id);
+  if (!TestBit(evictable_bits_, frame_id)) {
+    SetBit(evictable_bits_, frame_id);
+    evictable_size_++;
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= capacity_) {
+    return;
+  }
+  if (TestBit(evictable_bits_, frame_id)) {
+    ClearBit(evictable_bits_, frame_id);
+    evictable_size_--;
+  }
+  if (TestBit(pinned_bits_, frame_id)) {
+    ClearBit(pinned_bits_, frame_id);
+    pinned_size_--;
+  }
+  ClearBit(reference_bits_, frame_id);
 }
 
 /**
- * @breif count those State != EMPTY
- * @return the current size of replacer
+ * @return the number of frames the replacer tracks, pinned or evictable
  */
+size_t ClockReplacer::Size() { return pinned_size_ + evictable_size_; }
 
-size_t ClockReplacer::Size() {
-  return count_if(second_chance.begin(), second_chance.end(), IsEmpty);
-}
+size_t ClockReplacer::PinSize() { return pinned_size_; }
+
+size_t ClockReplacer::UnpinSize() { return evictable_size_; }
 
 /**
- * @param itr
- * @return if *itr != State::EMPTY, return true, otherwise false
+ * The hand takes frames without a reference bit in hand order first and the referenced ones on its second sweep, so the
+ * hottest frames are the referenced ones the hand reaches last.
  */
+vector<frame_id_t> ClockReplacer::HotFrames() {
+  vector<frame_id_t> cold;
+  vector<frame_id_t> hot;
+  for (size_t i = 0; i < capacity_; i++) {
+    size_t pos = (hand_ + i) % capacity_;
+    if (TestBit(evictable_bits_, pos)) {
+      (TestBit(reference_bits_, pos) ? hot : cold).push_back(static_cast<frame_id_t>(pos));
+    }
+  }
+  vector<frame_id_t> frames(hot.rbegin(), hot.rend());
+  frames.insert(frames.end(), cold.rbegin(), cold.rend());
+  return frames;
+}
 
-bool ClockReplacer::IsEmpty(ClockReplacer::State& item) {
-  return item != State::EMPTY;
-}
\ No newline at end of file
+void ClockReplacer::Resize(size_t num_pages) {
+  for (size_t pos = num_pages; pos < capacity_; pos++) {
+    if (TestBit(evictable_bits_, pos)) {
+      evictable_size_--;
+    }
+    if (TestBit(pinned_bits_, pos)) {
+      pinned_size_--;
+    }
+    ClearBit(reference_bits_, pos);
+    ClearBit(evictable_bits_, pos);
+    ClearBit(pinned_bits_, pos);
+  }
+  size_t words = (num_pages + 63) / 64;
+  reference_bits_.resize(words, 0);
+  evictable_bits_.resize(words, 0);
+  pinned_bits_.resize(words, 0);
+  capacity_ = num_pages;
+  if (hand_ >= capacity_) {
+    hand_ = 0;
+  }
+}
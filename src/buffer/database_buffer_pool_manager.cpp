@@ -0,0 +1,45 @@
+#include "buffer/database_buffer_pool_manager.h"
+
+DatabaseBufferPoolManager::DatabaseBufferPoolManager(BufferPoolManager *pool, DiskManager *disk_manager)
+    : BufferPoolManager(disk_manager), pool_(pool), file_id_(pool->AttachFile(disk_manager)) {}
+
+DatabaseBufferPoolManager::~DatabaseBufferPoolManager() { pool_->DetachFile(file_id_); }
+
+Page *DatabaseBufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return pool_->FetchFilePage(file_id_, page_id, strategy);
+}
+
+bool DatabaseBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return pool_->UnpinFilePage(file_id_, page_id, is_dirty);
+}
+
+bool DatabaseBufferPoolManager::FlushPage(page_id_t page_id) { return pool_->FlushFilePage(file_id_, page_id); }
+
+Page *DatabaseBufferPoolManager::NewPage(page_id_t &page_id) { return pool_->NewFilePage(file_id_, page_id); }
+
+bool DatabaseBufferPoolManager::DeletePage(page_id_t page_id) { return pool_->DeleteFilePage(file_id_, page_id); }
+
+void DatabaseBufferPoolManager::PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  pool_->PrefetchFilePage(file_id_, page_id, strategy);
+}
+
+bool DatabaseBufferPoolManager::IsPageLoading(page_id_t page_id) {
+  return pool_->IsFilePageLoading(file_id_, page_id);
+}
+
+size_t DatabaseBufferPoolManager::GetPoolSize() { return pool_->GetPoolSize(); }
+
+size_t DatabaseBufferPoolManager::ResizePool(size_t pool_size) { return pool_->ResizePool(pool_size); }
+
+vector<page_id_t> DatabaseBufferPoolManager::GetHotPages() { return pool_->GetFileHotPages(file_id_); }
+
+bool DatabaseBufferPoolManager::CheckAllUnpinned() { return pool_->CheckFileUnpinned(file_id_); }
+
+BufferPoolWriteStats DatabaseBufferPoolManager::GetWriteStats() { return pool_->GetWriteStats(); }
+
+BufferPoolStats DatabaseBufferPoolManager::GetStats() { return pool_->GetStats(); }
+
+void DatabaseBufferPoolManager::ResetStats() {
+  pool_->ResetStats();
+  BufferPoolManager::ResetStats();
+}
@@ -0,0 +1,122 @@
+#include "buffer/lru_k_replacer.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, uint64_t correlated_period)
+    : frames_(num_pages), k_(k == 0 ? 1 : k), correlated_period_(correlated_period) {}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+void LRUKReplacer::RecordAccess(FrameEntry &entry) {
+  uint64_t now = ++current_timestamp_;
+  if (!entry.history_.empty() && now - entry.history_.back() <= correlated_period_) {
+    // correlated reference, still the same logical access
+    entry.history_.back() = now;
+    return;
+  }
+  entry.history_.push_back(now);
+  if (entry.history_.size() > k_) {
+    entry.history_.pop_front();
+  }
+}
+
+uint64_t LRUKReplacer::EvictionKey(const FrameEntry &entry) const {
+  // with fewer than k accesses this is the first access, otherwise the k-th most recent one
+  return entry.history_.front();
+}
+
+set<pair<uint64_t, frame_id_t>> &LRUKReplacer::EvictionSet(const FrameEntry &entry) {
+  return entry.history_.size() < k_ ? history_list_ : cache_list_;
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  // infinite backward k-distance first, then the largest finite one
+  auto &victims = history_list_.empty() ? cache_list_ : history_list_;
+  if (victims.empty()) {
+    return false;
+  }
+  *frame_id = victims.begin()->second;
+  victims.erase(victims.begin());
+  // an evicted frame starts over with no history
+  frames_[*frame_id] = FrameEntry();
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    return;
+  }
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    EvictionSet(entry).erase({EvictionKey(entry), frame_id});
+    entry.evictable_ = false;
+    pin_size_++;
+  } else if (!entry.tracked_) {
+    entry.tracked_ = true;
+    pin_size_++;
+  }
+  RecordAccess(entry);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    return;
+  }
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    return;
+  }
+  if (entry.tracked_) {
+    pin_size_--;
+  }
+  entry.tracked_ = true;
+  entry.evictable_ = true;
+  if (entry.history_.empty()) {
+    // never pinned through this replacer, count the unpin as its first access
+    RecordAccess(entry);
+  }
+  EvictionSet(entry).emplace(EvictionKey(entry), frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= frames_.size()) {
+    return;
+  }
+  auto &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    EvictionSet(entry).erase({EvictionKey(entry), frame_id});
+  } else if (entry.tracked_) {
+    pin_size_--;
+  }
+  // the next page in the frame must not inherit the accesses of this one
+  entry = FrameEntry();
+}
+
+size_t LRUKReplacer::Size() { return pin_size_ + UnpinSize(); }
+
+size_t LRUKReplacer::PinSize() { return pin_size_; }
+
+size_t LRUKReplacer::UnpinSize() { return history_list_.size() + cache_list_.size(); }
+
+vector<frame_id_t> LRUKReplacer::HotFrames() {
+  // the reverse of the victim order: full histories by most recent k-th access, then the rest by latest first access
+  vector<frame_id_t> frames;
+  frames.reserve(UnpinSize());
+  for (auto it = cache_list_.rbegin(); it != cache_list_.rend(); ++it) {
+    frames.push_back(it->second);
+  }
+  for (auto it = history_list_.rbegin(); it != history_list_.rend(); ++it) {
+    frames.push_back(it->second);
+  }
+  return frames;
+}
+
+void LRUKReplacer::Resize(size_t num_pages) {
+  for (size_t frame_id = num_pages; frame_id < frames_.size(); frame_id++) {
+    auto &entry = frames_[frame_id];
+    if (entry.evictable_) {
+      EvictionSet(entry).erase({EvictionKey(entry), static_cast<frame_id_t>(frame_id)});
+    } else if (entry.tracked_) {
+      pin_size_--;
+    }
+  }
+  frames_.resize(num_pages);
+}
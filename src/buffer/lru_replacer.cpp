@@ -21,9 +21,10 @@ bool LRUReplacer::Victim(frame_id_t *frame_id) {
  * TODO: Student Implement
  */
 void LRUReplacer::Pin(frame_id_t frame_id) {
-  if (lru_unpin_set.find(frame_id) != lru_unpin_set.end()) {
-    lru_unpin_set.erase(frame_id);
-    lru_unpin_list.remove(frame_id);
+  auto unpin_it = lru_unpin_set.find(frame_id);
+  if (unpin_it != lru_unpin_set.end()) {
+    lru_unpin_list.erase(unpin_it->second);
+    lru_unpin_set.erase(unpin_it);
   } else if (Size() == max_pages)
     return;
   lru_pin_set.insert(frame_id);
@@ -38,14 +39,40 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
   } else if (Size() == max_pages)
     return;
   if (lru_unpin_set.find(frame_id) == lru_unpin_set.end()) {
-    lru_unpin_set.insert(frame_id);
     lru_unpin_list.push_front(frame_id);
+    lru_unpin_set.emplace(frame_id, lru_unpin_list.begin());
   }
 }
 
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  auto unpin_it = lru_unpin_set.find(frame_id);
+  if (unpin_it != lru_unpin_set.end()) {
+    lru_unpin_list.erase(unpin_it->second);
+    lru_unpin_set.erase(unpin_it);
+  }
+  lru_pin_set.erase(frame_id);
+}
+
 /**
  * TODO: Student Implement
  */
 size_t LRUReplacer::Size() { return lru_pin_set.size() + lru_unpin_set.size(); }
 size_t LRUReplacer::PinSize() { return lru_pin_set.size(); }
 size_t LRUReplacer::UnpinSize() { return lru_unpin_set.size(); }
+
+vector<frame_id_t> LRUReplacer::HotFrames() { return vector<frame_id_t>(lru_unpin_list.begin(), lru_unpin_list.end()); }
+
+void LRUReplacer::Resize(size_t num_pages) {
+  for (auto it = lru_unpin_list.begin(); it != lru_unpin_list.end();) {
+    if (static_cast<size_t>(*it) >= num_pages) {
+      lru_unpin_set.erase(*it);
+      it = lru_unpin_list.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (auto it = lru_pin_set.begin(); it != lru_pin_set.end();) {
+    it = static_cast<size_t>(*it) >= num_pages ? lru_pin_set.erase(it) : next(it);
+  }
+  max_pages = num_pages;
+}
@@ -0,0 +1,210 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type)
+    : BufferPoolManager(disk_manager) {
+  ASSERT(num_instances > 0, "Buffer pool needs at least one instance.");
+  size_t instance_size = (pool_size + num_instances - 1) / num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.push_back(new BufferPoolManager(instance_size, disk_manager, replacer_type));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetInstance(page_id)->FetchPage(page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) { return GetInstance(page_id)->FlushPage(page_id); }
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  page_id_t new_page_id = disk_manager_->AllocatePage();
+  Page *page = GetInstance(new_page_id)->NewFilePageWithId(0, new_page_id);
+  if (page == nullptr) {
+    disk_manager_->DeAllocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) { return GetInstance(page_id)->DeletePage(page_id); }
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->IsPageFree(page_id); }
+
+void ParallelBufferPoolManager::PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  GetInstance(page_id)->PrefetchPage(page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::IsPageLoading(page_id_t page_id) {
+  return page_id != INVALID_PAGE_ID && GetInstance(page_id)->IsPageLoading(page_id);
+}
+
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+void ParallelBufferPoolManager::StartBackgroundWriter(size_t clean_target, size_t max_writes_per_round,
+                                                      uint32_t interval_ms) {
+  size_t num_instances = instances_.size();
+  for (auto instance : instances_) {
+    instance->StartBackgroundWriter((clean_target + num_instances - 1) / num_instances,
+                                    (max_writes_per_round + num_instances - 1) / num_instances, interval_ms);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+BufferPoolWriteStats ParallelBufferPoolManager::GetWriteStats() {
+  BufferPoolWriteStats stats;
+  for (auto instance : instances_) {
+    auto instance_stats = instance->GetWriteStats();
+    stats.background_writes_ += instance_stats.background_writes_;
+    stats.eviction_writes_ += instance_stats.eviction_writes_;
+  }
+  return stats;
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+  for (auto instance : instances_) {
+    instance->ResetStats();
+  }
+  BufferPoolManager::ResetStats();
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+vector<page_id_t> ParallelBufferPoolManager::GetFileHotPages(file_id_t file_id) {
+  vector<vector<page_id_t>> instance_pages;
+  size_t longest = 0;
+  for (auto instance : instances_) {
+    instance_pages.push_back(instance->GetFileHotPages(file_id));
+    longest = max(longest, instance_pages.back().size());
+  }
+  vector<page_id_t> page_ids;
+  for (size_t rank = 0; rank < longest; rank++) {
+    for (auto &pages : instance_pages) {
+      if (rank < pages.size()) {
+        page_ids.push_back(pages[rank]);
+      }
+    }
+  }
+  return page_ids;
+}
+
+size_t ParallelBufferPoolManager::ResizePool(size_t pool_size) {
+  size_t instance_size = (pool_size + instances_.size() - 1) / instances_.size();
+  size_t resized = 0;
+  for (auto instance : instances_) {
+    resized += instance->ResizePool(instance_size);
+  }
+  return resized;
+}
+
+file_id_t ParallelBufferPoolManager::AttachFile(DiskManager *disk_manager) {
+  // files are attached and detached one at a time, so every instance hands out the same id
+  scoped_lock<recursive_mutex> lock(latch_);
+  file_id_t file_id = instances_[0]->AttachFile(disk_manager);
+  for (size_t i = 1; i < instances_.size(); i++) {
+    file_id_t instance_file_id = instances_[i]->AttachFile(disk_manager);
+    ASSERT(instance_file_id == file_id, "Instances attached a file under different ids.");
+  }
+  return file_id;
+}
+
+void ParallelBufferPoolManager::DetachFile(file_id_t file_id) {
+  scoped_lock<recursive_mutex> lock(latch_);
+  for (auto instance : instances_) {
+    instance->DetachFile(file_id);
+  }
+}
+
+Page *ParallelBufferPoolManager::FetchFilePage(file_id_t file_id, page_id_t page_id, BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetInstance(page_id)->FetchFilePage(file_id, page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::UnpinFilePage(file_id_t file_id, page_id_t page_id, bool is_dirty) {
+  return GetInstance(page_id)->UnpinFilePage(file_id, page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushFilePage(file_id_t file_id, page_id_t page_id) {
+  return GetInstance(page_id)->FlushFilePage(file_id, page_id);
+}
+
+Page *ParallelBufferPoolManager::NewFilePage(file_id_t file_id, page_id_t &page_id) {
+  DiskManager *disk_manager = instances_[0]->Disk(file_id);
+  page_id_t new_page_id = disk_manager->AllocatePage();
+  Page *page = GetInstance(new_page_id)->NewFilePageWithId(file_id, new_page_id);
+  if (page == nullptr) {
+    disk_manager->DeAllocatePage(new_page_id);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeleteFilePage(file_id_t file_id, page_id_t page_id) {
+  return GetInstance(page_id)->DeleteFilePage(file_id, page_id);
+}
+
+void ParallelBufferPoolManager::PrefetchFilePage(file_id_t file_id, page_id_t page_id,
+                                                 BufferAccessStrategy *strategy) {
+  if (page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  GetInstance(page_id)->PrefetchFilePage(file_id, page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::IsFilePageLoading(file_id_t file_id, page_id_t page_id) {
+  return page_id != INVALID_PAGE_ID && GetInstance(page_id)->IsFilePageLoading(file_id, page_id);
+}
+
+bool ParallelBufferPoolManager::CheckFileUnpinned(file_id_t file_id) {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckFileUnpinned(file_id) && res;
+  }
+  return res;
+}
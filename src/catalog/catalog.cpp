@@ -1,4 +1,8 @@
 #include "catalog/catalog.h"
+
+#include <algorithm>
+#include <thread>
+
 #include "index/b_plus_tree.h"
 
 void CatalogMeta::SerializeTo(char *buf) const {
@@ -79,31 +83,27 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
         next_table_id_.store(0);
     } else {   //read from old
         catalog_meta_ = new CatalogMeta;
-        Page *meta_page_ = buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
-        catalog_meta_ = catalog_meta_->DeserializeFrom(meta_page_->GetData());
+        ReadPageGuard meta_guard = buffer_pool_manager_->FetchPageRead(CATALOG_META_PAGE_ID);
+        catalog_meta_ = catalog_meta_->DeserializeFrom(meta_guard.As<Page>()->GetData());
+        meta_guard.Drop();
         next_index_id_.store(0);
         next_table_id_.store(0);
+        // only the names are read here, the tables and indexes themselves are loaded on first reference
         for (auto iter: catalog_meta_->table_meta_pages_) {
             if (next_table_id_ <= iter.first) next_table_id_.store(iter.first + 1);
-            TableMetadata *old_table_meta_data;
-            Page *old_table_page = buffer_pool_manager_->FetchPage(iter.second);
-            old_table_meta_data = nullptr;
-            //copy table_metadata
-            old_table_meta_data->DeserializeFrom(old_table_page->GetData(), old_table_meta_data);
+            TableMetadata *old_table_meta_data = nullptr;
+            ReadPageGuard old_table_guard = buffer_pool_manager_->FetchPageRead(iter.second);
+            TableMetadata::DeserializeFrom(old_table_guard.As<Page>()->GetData(), old_table_meta_data);
+            old_table_guard.Drop();
             table_names_.emplace(old_table_meta_data->GetTableName(), iter.first);
-            TableHeap *old_table_heap = nullptr;
-            old_table_heap = old_table_heap->Create(buffer_pool_manager_, old_table_meta_data->GetFirstPageId(),
-                                                    old_table_meta_data->schema_, nullptr, nullptr);
-            TableInfo *old_table_info = old_table_info->Create();
-            old_table_info->Init(old_table_meta_data, old_table_heap);
-            tables_.emplace(iter.first, old_table_info);
+            delete old_table_meta_data;
         }
         for (auto iter: catalog_meta_->index_meta_pages_) {
             if (next_index_id_ <= iter.first) next_index_id_.store(iter.first + 1);
             IndexMetadata *old_index_meta_data = nullptr;
-            Page *old_index_page = buffer_pool_manager_->FetchPage(iter.second);
-            //copy index_metadata
-            old_index_meta_data->DeserializeFrom(old_index_page->GetData(), old_index_meta_data);
+            ReadPageGuard old_index_guard = buffer_pool_manager_->FetchPageRead(iter.second);
+            IndexMetadata::DeserializeFrom(old_index_guard.As<Page>()->GetData(), old_index_meta_data);
+            old_index_guard.Drop();
             //find table
             string old_table_name;
             for (auto it: table_names_) {
@@ -112,16 +112,16 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
                     break;
                 }
             }
-            string old_index_name = old_index_meta_data->GetIndexName();
-            index_names_[old_table_name][old_index_name] = iter.first;
-            IndexInfo *old_index_info = old_index_info->Create();
-            old_index_info->Init(old_index_meta_data, tables_[old_index_meta_data->GetTableId()], buffer_pool_manager_);
-            indexes_.emplace(iter.first, old_index_info);
+            index_names_[old_table_name][old_index_meta_data->GetIndexName()] = iter.first;
+            delete old_index_meta_data;
         }
     }
 }
 //destructor
 CatalogManager::~CatalogManager() {
+    for (auto iter: tables_) {
+        FlushTableMetaPage(iter.second);
+    }
     FlushCatalogMetaPage();
     if (catalog_meta_ != NULL) {
         delete catalog_meta_;
@@ -149,20 +149,23 @@ dberr_t CatalogManager::CreateTable(const std::string &table_name, TableSchema *
     } while (0);
     table_names_.emplace(table_name, new_table_id_);
     page_id_t new_table_page_id_;
-    buffer_pool_manager_->NewPage(new_table_page_id_);
+    WritePageGuard new_table_guard = buffer_pool_manager_->NewPageGuarded(new_table_page_id_);
     table_info = table_info->Create();
     //create tableheap
     TableHeap *new_table_heap = new_table_heap->Create(buffer_pool_manager_, schema, txn, log_manager_, lock_manager_);
     page_id_t new_heap_root_id = new_table_heap->GetFirstPageId();
     //create table_metadata
     TableMetadata *new_table_meta_data = new_table_meta_data->Create(new_table_id_, table_name, new_heap_root_id,
-                                                                     schema);
+                                                                     schema, new_table_heap->GetLastPageId(),
+                                                                     new_table_heap->GetFreeSpaceMapPageId());
     //write table_metadata to disk
-    new_table_meta_data->SerializeTo(buffer_pool_manager_->FetchPage(new_table_page_id_)->GetData());
+    new_table_meta_data->SerializeTo(new_table_guard.AsMut<Page>()->GetData());
+    new_table_guard.Drop();
     buffer_pool_manager_->FlushPage(new_table_page_id_);
 
     //new_table_meta_data->root_page_id_ = new_table_heap->GetFirstPageId();
     table_info->Init(new_table_meta_data, new_table_heap);
+    new_table_heap->SetBufferPoolCounters(buffer_pool_manager_->GetOwnerCounters("table " + table_name));
     tables_.emplace(new_table_id_, table_info);
 
     catalog_meta_->table_meta_pages_.emplace(new_table_id_, new_table_page_id_);
@@ -178,17 +181,18 @@ dberr_t CatalogManager::CreateTable(const std::string &table_name, TableSchema *
 dberr_t CatalogManager::GetTable(const std::string &table_name, TableInfo *&table_info) {
     auto find_table_name = table_names_.find(table_name);
     if (find_table_name == table_names_.end()) return DB_TABLE_NOT_EXIST;
-    auto find_table_info = tables_.find(find_table_name->second);
-    table_info = find_table_info->second;
-    return DB_SUCCESS;
+    return GetTable(find_table_name->second, table_info);
 }
 
 /**
  * TODO: Student Implement
  */
-dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
-    for (auto it = tables_.begin(); it != tables_.end(); it++) {
-        tables.push_back(it->second);
+dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) {
+    for (auto it: catalog_meta_->table_meta_pages_) {
+        TableInfo *table_info;
+        if (GetTable(it.first, table_info) == DB_SUCCESS) {
+            tables.push_back(table_info);
+        }
     }
     return DB_SUCCESS;
 }
@@ -224,8 +228,10 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
         auto find_index_2 = find_index->second.find(index_name);
         if (find_index_2 != find_index->second.end()) return DB_INDEX_ALREADY_EXIST;
     }
+    TableInfo *table_info;
+    if (GetTable(find_table->second, table_info) != DB_SUCCESS) return DB_TABLE_NOT_EXIST;
     //construct schema map
-    Schema *table_schema_used = tables_[find_table->second]->GetSchema();
+    Schema *table_schema_used = table_info->GetSchema();
     std::vector<uint32_t> new_key_map_;
     for (auto it = index_keys.begin(); it != index_keys.end(); it++) {
         uint32_t i;
@@ -248,34 +254,49 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
     index_info = index_info->Create();
     //write index_metadata to disk
     page_id_t new_index_page_id_;
-    buffer_pool_manager_->NewPage(new_index_page_id_);
-    IndexMetadata *new_index_meta = new_index_meta->Create(new_index_id_, index_name, find_table->second, new_key_map_);
+    WritePageGuard new_index_guard = buffer_pool_manager_->NewPageGuarded(new_index_page_id_);
+    IndexMetadata *new_index_meta = new_index_meta->Create(new_index_id_, index_name, find_table->second, new_key_map_,
+                                                           KeyManager::ChooseEncoding(table_schema_used, new_key_map_));
     catalog_meta_->index_meta_pages_.emplace(new_index_id_, new_index_page_id_);
-    new_index_meta->SerializeTo(buffer_pool_manager_->FetchPage(new_index_page_id_)->GetData());
+    new_index_meta->SerializeTo(new_index_guard.AsMut<Page>()->GetData());
+    new_index_guard.Drop();
     buffer_pool_manager_->FlushPage(new_index_page_id_);
     //init info
-    index_info->Init(new_index_meta, tables_[find_table->second], buffer_pool_manager_);
+    index_info->Init(new_index_meta, table_info, buffer_pool_manager_);
     indexes_.emplace(new_index_id_, index_info);
     next_index_id_.store(next_index_id_ + 1);
     auto this_index = index_info->GetIndex();
-    auto table_heap = tables_[find_table->second]->GetTableHeap();
-    auto table_iterator = table_heap->Begin(txn);
-    while (table_iterator != table_heap->End()) {
-        RowId rid = table_iterator->GetRowId();
-        Row row = *table_iterator;
-        Row index_row(rid);
-        row.GetKeyFromRow(tables_[find_table->second]->GetSchema(), index_info->GetIndexKeySchema(), index_row);
-        this_index->InsertEntry(index_row, rid, txn);
-        table_iterator++;
+    auto table_heap = table_info->GetTableHeap();
+    // the index gets every key at once and builds itself bottom up instead of taking one insert per row. The table
+    // is read and the keys are extracted and sorted by several threads, each on its own part of the table
+    size_t num_workers = std::max<size_t>(
+            1, std::min<size_t>(INDEX_BUILD_MAX_THREADS, std::thread::hardware_concurrency()));
+    dberr_t result = this_index->BulkLoad(
+            num_workers,
+            [&](const Index::EntryConsumer &add) {
+                return table_heap->PartitionedScan(num_workers, [&](size_t worker, Row &row) {
+                    Row index_row(row.GetRowId());
+                    row.GetKeyFromRow(table_info->GetSchema(), index_info->GetIndexKeySchema(), index_row);
+                    add(worker, index_row, row.GetRowId());
+                });
+            },
+            txn);
+    if (result != DB_SUCCESS) {
+        // an index missing rows must not be used, take back everything registered for it above
+        this_index->Destroy();
+        DropIndex(table_name, index_name);
+        buffer_pool_manager_->DeletePage(new_index_page_id_);
+        delete index_info;
+        index_info = nullptr;
     }
-    return DB_SUCCESS;
+    return result;
 }
 
 /**
  * TODO: Student Implement
  */
 dberr_t CatalogManager::GetIndex(const std::string &table_name, const std::string &index_name,
-                                 IndexInfo *&index_info) const {
+                                 IndexInfo *&index_info) {
     // ASSERT(false, "Not Implemented yet");
     //return DB_FAILED;
     auto find_table = table_names_.find(table_name);
@@ -286,15 +307,13 @@ dberr_t CatalogManager::GetIndex(const std::string &table_name, const std::strin
     if (find_table_index.size() == 0) return DB_INDEX_NOT_FOUND;
     auto find_index = find_table_index.find(index_name);
     if (find_index == find_table_index.end()) return DB_INDEX_NOT_FOUND;
-    auto get_index = indexes_.find(find_table_index[index_name]);
-    index_info = get_index->second;
-    return DB_SUCCESS;
+    return GetIndex(find_index->second, index_info);
 }
 
 /**
  * TODO: Student Implement
  */
-dberr_t CatalogManager::GetTableIndexes(const std::string &table_name, std::vector<IndexInfo *> &indexes) const {
+dberr_t CatalogManager::GetTableIndexes(const std::string &table_name, std::vector<IndexInfo *> &indexes) {
     auto find_table = table_names_.find(table_name);
     if (find_table == table_names_.end()) return DB_TABLE_NOT_EXIST;
     auto find_table_index = index_names_.find(table_name);
@@ -302,7 +321,10 @@ dberr_t CatalogManager::GetTableIndexes(const std::string &table_name, std::vect
     std::unordered_map<std::string, index_id_t> check_index_id;
     check_index_id = index_names_.at(table_name);
     for (auto insert = check_index_id.begin(); insert != check_index_id.end(); insert++) {
-        indexes.push_back(indexes_.at(insert->second));
+        IndexInfo *index_info;
+        if (GetIndex(insert->second, index_info) == DB_SUCCESS) {
+            indexes.push_back(index_info);
+        }
     }
     if (indexes.size() == 0) return DB_INDEX_NOT_FOUND;
     else return DB_SUCCESS;
@@ -332,9 +354,65 @@ dberr_t CatalogManager::DropIndex(const std::string &table_name, const std::stri
 /**
  * TODO: Student Implement
  */
+dberr_t CatalogManager::VacuumTable(const std::string &table_name, Transaction *txn, uint32_t &removed_rows,
+                                    uint32_t &freed_pages) {
+    TableInfo *table_info = nullptr;
+    dberr_t result = GetTable(table_name, table_info);
+    if (result != DB_SUCCESS) return result;
+    removed_rows = table_info->GetTableHeap()->Vacuum(txn, &freed_pages);
+    // the saved last page may be one of the pages that were given back
+    return FlushTableMetaPage(table_info);
+}
+
+dberr_t CatalogManager::TruncateTable(const std::string &table_name, Transaction *txn, uint32_t &removed_rows) {
+    TableInfo *table_info = nullptr;
+    dberr_t result = GetTable(table_name, table_info);
+    if (result != DB_SUCCESS) return result;
+    removed_rows = table_info->GetTableHeap()->Truncate(txn);
+    // an empty tree is all an index of an empty table needs, the next insert starts a new root
+    vector<IndexInfo *> indexes;
+    GetTableIndexes(table_name, indexes);
+    for (auto index_info: indexes) {
+        index_info->GetIndex()->Destroy();
+    }
+    // the heap has a new free space map
+    return FlushTableMetaPage(table_info);
+}
+
+uint32_t CatalogManager::VacuumLoadedTables(uint32_t min_pending_deletes) {
+    uint32_t removed_rows = 0;
+    for (auto &it: tables_) {
+        TableHeap *table_heap = it.second->GetTableHeap();
+        if (table_heap->GetPendingDeletes() == 0 || table_heap->GetPendingDeletes() < min_pending_deletes) {
+            continue;
+        }
+        removed_rows += table_heap->Vacuum(nullptr);
+        FlushTableMetaPage(it.second);
+    }
+    return removed_rows;
+}
+
+dberr_t CatalogManager::FlushTableMetaPage(TableInfo *table_info) const {
+    TableMetadata *table_meta = table_info->GetTableMetadata();
+    TableHeap *table_heap = table_info->GetTableHeap();
+    if (table_meta->last_page_id_ == table_heap->GetLastPageId() &&
+        table_meta->free_space_map_page_id_ == table_heap->GetFreeSpaceMapPageId()) {
+        return DB_SUCCESS;
+    }
+    auto meta_page = catalog_meta_->table_meta_pages_.find(table_info->GetTableId());
+    if (meta_page == catalog_meta_->table_meta_pages_.end()) return DB_TABLE_NOT_EXIST;
+    table_meta->last_page_id_ = table_heap->GetLastPageId();
+    table_meta->free_space_map_page_id_ = table_heap->GetFreeSpaceMapPageId();
+    WritePageGuard table_guard = buffer_pool_manager_->FetchPageWrite(meta_page->second);
+    if (!table_guard) return DB_FAILED;
+    table_meta->SerializeTo(table_guard.AsMut<Page>()->GetData());
+    return DB_SUCCESS;
+}
+
 dberr_t CatalogManager::FlushCatalogMetaPage() const {
-    Page *tem_page_ = buffer_pool_manager_->FetchPage(CATALOG_META_PAGE_ID);
-    catalog_meta_->SerializeTo(tem_page_->GetData());
+    WritePageGuard meta_guard = buffer_pool_manager_->FetchPageWrite(CATALOG_META_PAGE_ID);
+    catalog_meta_->SerializeTo(meta_guard.AsMut<Page>()->GetData());
+    meta_guard.Drop();
     buffer_pool_manager_->FlushPage(CATALOG_META_PAGE_ID);
     return DB_SUCCESS;
 }
@@ -345,7 +423,59 @@ dberr_t CatalogManager::FlushCatalogMetaPage() const {
  */
 dberr_t CatalogManager::GetTable(const table_id_t table_id, TableInfo *&table_info) {
     auto find_table = tables_.find(table_id);
-    if (find_table == tables_.end()) return DB_TABLE_NOT_EXIST;
-    table_info = tables_[table_id];
+    if (find_table == tables_.end()) {
+        auto find_meta_page = catalog_meta_->table_meta_pages_.find(table_id);
+        if (find_meta_page == catalog_meta_->table_meta_pages_.end()) return DB_TABLE_NOT_EXIST;
+        dberr_t result = LoadTable(table_id, find_meta_page->second);
+        if (result != DB_SUCCESS) return result;
+        find_table = tables_.find(table_id);
+    }
+    table_info = find_table->second;
+    return DB_SUCCESS;
+}
+
+dberr_t CatalogManager::GetIndex(const index_id_t index_id, IndexInfo *&index_info) {
+    auto find_index = indexes_.find(index_id);
+    if (find_index == indexes_.end()) {
+        auto find_meta_page = catalog_meta_->index_meta_pages_.find(index_id);
+        if (find_meta_page == catalog_meta_->index_meta_pages_.end()) return DB_INDEX_NOT_FOUND;
+        dberr_t result = LoadIndex(index_id, find_meta_page->second);
+        if (result != DB_SUCCESS) return result;
+        find_index = indexes_.find(index_id);
+    }
+    index_info = find_index->second;
+    return DB_SUCCESS;
+}
+
+dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t page_id) {
+    TableMetadata *table_meta = nullptr;
+    ReadPageGuard table_guard = buffer_pool_manager_->FetchPageRead(page_id);
+    if (!table_guard) return DB_FAILED;
+    TableMetadata::DeserializeFrom(table_guard.As<Page>()->GetData(), table_meta);
+    table_guard.Drop();
+    TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_, table_meta->GetFirstPageId(), table_meta->schema_,
+                                              log_manager_, lock_manager_, table_meta->GetLastPageId(),
+                                              table_meta->GetFreeSpaceMapPageId());
+    table_heap->SetBufferPoolCounters(buffer_pool_manager_->GetOwnerCounters("table " + table_meta->GetTableName()));
+    TableInfo *table_info = TableInfo::Create();
+    table_info->Init(table_meta, table_heap);
+    tables_.emplace(table_id, table_info);
+    return DB_SUCCESS;
+}
+
+dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t page_id) {
+    IndexMetadata *index_meta = nullptr;
+    ReadPageGuard index_guard = buffer_pool_manager_->FetchPageRead(page_id);
+    if (!index_guard) return DB_FAILED;
+    IndexMetadata::DeserializeFrom(index_guard.As<Page>()->GetData(), index_meta);
+    index_guard.Drop();
+    TableInfo *table_info;
+    if (GetTable(index_meta->GetTableId(), table_info) != DB_SUCCESS) {
+        delete index_meta;
+        return DB_TABLE_NOT_EXIST;
+    }
+    IndexInfo *index_info = IndexInfo::Create();
+    index_info->Init(index_meta, table_info, buffer_pool_manager_);
+    indexes_.emplace(index_id, index_info);
     return DB_SUCCESS;
 }
\ No newline at end of file
@@ -1,20 +1,27 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, KeyEncoding key_encoding)
+    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map),
+      key_encoding_(key_encoding) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, KeyEncoding key_encoding) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, key_encoding);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
     char *p = buf;
     uint32_t ofs = GetSerializedSize();
     ASSERT(ofs <= PAGE_SIZE, "Failed to serialize index info.");
-    // magic num
-    MACH_WRITE_UINT32(buf, INDEX_METADATA_MAGIC_NUM);
+    // magic num, it also records the key encoding
+    uint32_t magic_num = INDEX_METADATA_MAGIC_NUM;
+    if (key_encoding_ == KeyEncoding::kMemcomparable) {
+        magic_num = INDEX_METADATA_MEMCOMPARABLE_MAGIC_NUM;
+    } else if (key_encoding_ == KeyEncoding::kInt32) {
+        magic_num = INDEX_METADATA_INT32_MAGIC_NUM;
+    }
+    MACH_WRITE_UINT32(buf, magic_num);
     buf += 4;
     // index id
     MACH_WRITE_TO(index_id_t, buf, index_id_);
@@ -55,7 +62,9 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     // magic num
     uint32_t magic_num = MACH_READ_UINT32(buf);
     buf += 4;
-    ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM, "Failed to deserialize index info.");
+    ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM || magic_num == INDEX_METADATA_MEMCOMPARABLE_MAGIC_NUM ||
+           magic_num == INDEX_METADATA_INT32_MAGIC_NUM,
+           "Failed to deserialize index info.");
     // index id
     index_id_t index_id = MACH_READ_FROM(index_id_t, buf);
     buf += 4;
@@ -78,26 +87,44 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
         key_map.push_back(key_index);
     }
     // allocate space for index meta data
-    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+    // the keys of an index written under the old magic number are serialized rows
+    KeyEncoding key_encoding = KeyEncoding::kRow;
+    if (magic_num == INDEX_METADATA_MEMCOMPARABLE_MAGIC_NUM) {
+        key_encoding = KeyEncoding::kMemcomparable;
+    } else if (magic_num == INDEX_METADATA_INT32_MAGIC_NUM) {
+        key_encoding = KeyEncoding::kInt32;
+    }
+    index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, key_encoding);
     return buf - p;
 }
 
 Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type) {
+  KeyEncoding key_encoding = meta_data_->GetKeyEncoding();
   size_t max_size = 0;
-  for (auto col : key_schema_->GetColumns()) {
-    max_size += col->GetLength();
+  // a row key also needs room for the row header, a memcomparable key is exactly its encoded size
+  size_t header_size = 8;
+  if (key_encoding == KeyEncoding::kMemcomparable) {
+    max_size = KeyManager::GetMemcomparableSize(key_schema_);
+    header_size = 0;
+  } else {
+    for (auto col : key_schema_->GetColumns()) {
+      max_size += col->GetLength();
+    }
   }
   // only bptree, hash not implemented yet
   if (index_type == "bptree") {   //adjust size
-    if (max_size <= 8)
+    // integer keys are stored densely, rounding them up to a bucket would give the fanout away again
+    if (key_encoding == KeyEncoding::kInt32)
+      max_size = sizeof(int32_t);
+    else if (max_size + header_size <= 16)
       max_size = 16;
-    else if (max_size <= 24)
+    else if (max_size + header_size <= 32)
       max_size = 32;
-    else if (max_size <= 56)
+    else if (max_size + header_size <= 64)
       max_size = 64;
-    else if (max_size <= 120)
+    else if (max_size + header_size <= 128)
       max_size = 128;
-    else if (max_size <= 248)
+    else if (max_size + header_size <= 256)
       max_size = 256;
     else {
       LOG(ERROR) << "GenericKey size is too large";
@@ -106,5 +133,5 @@ Index *IndexInfo::CreateIndex(BufferPoolManager *buffer_pool_manager, const stri
   } else {
     return nullptr;
   }
-  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+  return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager, key_encoding);
 }
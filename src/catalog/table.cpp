@@ -5,7 +5,7 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
     uint32_t ofs = GetSerializedSize();
     ASSERT(ofs <= PAGE_SIZE, "Failed to serialize table info.");
     // magic num
-    MACH_WRITE_UINT32(buf, TABLE_METADATA_MAGIC_NUM);
+    MACH_WRITE_UINT32(buf, TABLE_METADATA_WITH_HEAP_PAGES_MAGIC_NUM);
     buf += 4;
     // table id
     MACH_WRITE_TO(table_id_t, buf, table_id_);
@@ -20,6 +20,11 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
     buf += 4;
     // table schema
     buf += schema_->SerializeTo(buf);
+    // table heap last page id and free space map page id
+    MACH_WRITE_TO(page_id_t, buf, last_page_id_);
+    buf += 4;
+    MACH_WRITE_TO(page_id_t, buf, free_space_map_page_id_);
+    buf += 4;
     ASSERT(buf - p == ofs, "Unexpected serialize size.");
     return ofs;
 }
@@ -29,8 +34,9 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
  * TODO: Student Implement
  */
 uint32_t TableMetadata::GetSerializedSize() const {
-    //size = magic_num + table_id + table_name_length + table_name + root_page_id + schema_size
-    return 16 + table_name_.length() + schema_->GetSerializedSize();
+    //size = magic_num + table_id + table_name_length + table_name + root_page_id + schema_size + last_page_id
+    //       + free_space_map_page_id
+    return 24 + table_name_.length() + schema_->GetSerializedSize();
 }
 
 uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
@@ -41,7 +47,8 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
     // magic num
     uint32_t magic_num = MACH_READ_UINT32(buf);
     buf += 4;
-    ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM, "Failed to deserialize table info.");
+    ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM || magic_num == TABLE_METADATA_WITH_HEAP_PAGES_MAGIC_NUM,
+           "Failed to deserialize table info.");
     // table id
     table_id_t table_id = MACH_READ_FROM(table_id_t, buf);
     buf += 4;
@@ -56,8 +63,17 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
     // table schema
     TableSchema *schema = nullptr;
     buf += TableSchema::DeserializeFrom(buf, schema);
+    // table heap last page id and free space map page id, tables written before they were recorded have neither
+    page_id_t last_page_id = INVALID_PAGE_ID;
+    page_id_t free_space_map_page_id = INVALID_PAGE_ID;
+    if (magic_num == TABLE_METADATA_WITH_HEAP_PAGES_MAGIC_NUM) {
+        last_page_id = MACH_READ_FROM(page_id_t, buf);
+        buf += 4;
+        free_space_map_page_id = MACH_READ_FROM(page_id_t, buf);
+        buf += 4;
+    }
     // allocate space for table metadata
-    table_meta = new TableMetadata(table_id, table_name, root_page_id, schema);
+    table_meta = new TableMetadata(table_id, table_name, root_page_id, schema, last_page_id, free_space_map_page_id);
     return buf - p;
 }
 
@@ -67,10 +83,12 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                                     TableSchema *schema) {
-    return new TableMetadata(table_id, table_name, root_page_id, schema);
+                                     TableSchema *schema, page_id_t last_page_id, page_id_t free_space_map_page_id) {
+    return new TableMetadata(table_id, table_name, root_page_id, schema, last_page_id, free_space_map_page_id);
 }
 // init
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                             page_id_t last_page_id, page_id_t free_space_map_page_id)
         : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id),
-          schema_(Schema::DeepCopySchema(schema)) {}
+          schema_(Schema::DeepCopySchema(schema)), last_page_id_(last_page_id),
+          free_space_map_page_id_(free_space_map_page_id) {}
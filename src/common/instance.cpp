@@ -3,16 +3,28 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+#include "buffer/database_buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size, DurabilityMode durability,
+                                 BufferPoolManager *shared_pool)
     : db_file_name_(std::move(db_name)), init_(init) {
   // Init database file if needed
+  warm_up_file_name_ = WarmUpFileName(db_file_name_);
   db_file_name_ = "./databases/" + db_file_name_;
   if (init_) {
     remove(db_file_name_.c_str());
+    remove(warm_up_file_name_.c_str());
   }
   // Initialize components
   disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  if (shared_pool != nullptr) {
+    bpm_ = new DatabaseBufferPoolManager(shared_pool, disk_mgr_);
+  } else if (DEFAULT_BUFFER_POOL_INSTANCES > 1) {
+    bpm_ = new ParallelBufferPoolManager(DEFAULT_BUFFER_POOL_INSTANCES, buffer_pool_size, disk_mgr_);
+  } else {
+    bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  }
 
   // Allocate static page for db storage engine
   if (init) {
@@ -39,14 +51,29 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
     ASSERT(!bpm_->IsPageFree(INDEX_ROOTS_PAGE_ID), "Invalid header page.");
   }
   catalog_mgr_ = new CatalogManager(bpm_, nullptr, nullptr, init);
+  SetDurabilityMode(durability);
+  bpm_->StartBackgroundWriter();
+  // read back what was hot when the database was last closed, queries do not wait for it
+  if (!init) {
+    bpm_->StartWarmUp(warm_up_file_name_);
+  }
 }
 
 DBStorageEngine::~DBStorageEngine() {
   delete catalog_mgr_;
+  bpm_->SaveWarmUpList(warm_up_file_name_);
   delete bpm_;
   delete disk_mgr_;
 }
 
+void DBStorageEngine::SetDurabilityMode(DurabilityMode durability) { disk_mgr_->SetDurabilityMode(durability); }
+
+void DBStorageEngine::EndStatement() {
+  if (disk_mgr_->GetDurabilityMode() == DurabilityMode::kStatement) {
+    disk_mgr_->Sync(false);
+  }
+}
+
 std::unique_ptr<ExecuteContext> DBStorageEngine::MakeExecuteContext(Transaction *txn) {
   return std::make_unique<ExecuteContext>(txn, catalog_mgr_, bpm_);
 }
@@ -6,11 +6,13 @@
 
 #include <chrono>
 
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/result_writer.h"
 #include "executor/executors/delete_executor.h"
 #include "executor/executors/index_scan_executor.h"
 #include "executor/executors/insert_executor.h"
 #include "executor/executors/seq_scan_executor.h"
+#include "executor/executors/truncate_executor.h"
 #include "executor/executors/update_executor.h"
 #include "executor/executors/values_executor.h"
 #include "glog/logging.h"
@@ -27,7 +29,15 @@ int yyparse(void);
 
 #include <set>
 bool IsExecuteFile = false;
-ExecuteEngine::ExecuteEngine() {
+ExecuteEngine::ExecuteEngine(DurabilityMode durability) : durability_(durability) {
+    // one pool for every database, its pages are kept per (database file, page id). Sharded like the pool of a
+    // single database, so that open databases do not all wait on one latch
+    if (DEFAULT_BUFFER_POOL_INSTANCES > 1) {
+        buffer_pool_ = new ParallelBufferPoolManager(DEFAULT_BUFFER_POOL_INSTANCES, DEFAULT_BUFFER_POOL_SIZE, nullptr);
+    } else {
+        buffer_pool_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, nullptr);
+    }
+    buffer_pool_->StartBackgroundWriter();
     char path[] = "./databases";
     DIR *dir;
     if ((dir = opendir(path)) == nullptr) {
@@ -40,9 +50,46 @@ ExecuteEngine::ExecuteEngine() {
             strcmp(stdir->d_name, "..") == 0 ||
             stdir->d_name[0] == '.')
             continue;
-        dbs_[stdir->d_name] = new DBStorageEngine(stdir->d_name, false);
+        // opened by the first USE, so startup does not depend on how many databases there are or how large
+        dbs_[stdir->d_name] = nullptr;
     }
     closedir(dir);
+    StartVacuumWorker();
+}
+
+void ExecuteEngine::StartVacuumWorker(uint32_t min_deletes, uint32_t interval_ms) {
+    StopVacuumWorker();
+    vacuum_stop_ = false;
+    vacuum_worker_ = std::thread(&ExecuteEngine::VacuumWorkerLoop, this, min_deletes, interval_ms);
+}
+
+void ExecuteEngine::VacuumWorkerLoop(uint32_t min_deletes, uint32_t interval_ms) {
+    std::unique_lock<std::mutex> lock(vacuum_latch_);
+    while (!vacuum_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms), [this] { return vacuum_stop_; })) {
+        lock.unlock();
+        {
+            // a table may only be vacuumed while no statement reads or writes it
+            std::scoped_lock<std::mutex> statement_lock(statement_latch_);
+            for (auto &db : dbs_) {
+                if (db.second != nullptr && db.second->catalog_mgr_->VacuumLoadedTables(min_deletes) > 0) {
+                    db.second->EndStatement();
+                }
+            }
+        }
+        lock.lock();
+    }
+}
+
+void ExecuteEngine::StopVacuumWorker() {
+    if (!vacuum_worker_.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock<std::mutex> lock(vacuum_latch_);
+        vacuum_stop_ = true;
+    }
+    vacuum_cv_.notify_all();
+    vacuum_worker_.join();
 }
 
 std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *exec_ctx,
@@ -68,6 +115,9 @@ std::unique_ptr<AbstractExecutor> ExecuteEngine::CreateExecutor(ExecuteContext *
             auto child_executor = CreateExecutor(exec_ctx, delete_plan->GetChildPlan());
             return std::make_unique<DeleteExecutor>(exec_ctx, delete_plan, std::move(child_executor));
         }
+        case PlanType::Truncate: {
+            return std::make_unique<TruncateExecutor>(exec_ctx, dynamic_cast<const TruncatePlanNode *>(plan.get()));
+        }
         case PlanType::Insert: {
             auto insert_plan = dynamic_cast<const InsertPlanNode *>(plan.get());
             auto child_executor = CreateExecutor(exec_ctx, insert_plan->GetChildPlan());
@@ -115,6 +165,22 @@ dberr_t ExecuteEngine::ExecutePlan(const AbstractPlanNodeRef &plan, std::vector<
 }
 
 dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
+    // the statements of an executed file take the latch one by one, so the vacuum worker can run in between
+    std::unique_lock<std::mutex> lock(statement_latch_, std::defer_lock);
+    if (ast == nullptr || ast->type_ != kNodeExecFile) {
+        lock.lock();
+    }
+    dberr_t result = ExecuteStatement(ast);
+    // statement boundary for the statement durability mode
+    for (auto &db : dbs_) {
+        if (db.second != nullptr) {
+            db.second->EndStatement();
+        }
+    }
+    return result;
+}
+
+dberr_t ExecuteEngine::ExecuteStatement(pSyntaxNode ast) {
     if (ast == nullptr) {
         return DB_FAILED;
     }
@@ -139,10 +205,16 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast) {
             return ExecuteDropTable(ast, context.get());
         case kNodeShowIndexes:
             return ExecuteShowIndexes(ast, context.get());
+        case kNodeShowBufferStatus:
+            return ExecuteShowBufferStatus(ast, context.get());
+        case kNodeSetBufferPool:
+            return ExecuteSetBufferPool(ast, context.get());
         case kNodeCreateIndex:
             return ExecuteCreateIndex(ast, context.get());
         case kNodeDropIndex:
             return ExecuteDropIndex(ast, context.get());
+        case kNodeVacuum:
+            return ExecuteVacuum(ast, context.get());
         case kNodeTrxBegin:
             return ExecuteTrxBegin(ast, context.get());
         case kNodeTrxCommit:
@@ -262,7 +334,8 @@ dberr_t ExecuteEngine::ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *co
     string database_name = ast->val_;
     auto it = dbs_.find(database_name);
     if (it == dbs_.end()) {
-        DBStorageEngine *new_db = new DBStorageEngine(database_name, true);
+        DBStorageEngine *new_db =
+                new DBStorageEngine(database_name, true, DEFAULT_BUFFER_POOL_SIZE, durability_, buffer_pool_);
         dbs_.emplace(database_name, new_db);
         endTime = clock();
         cout << "Query OK, 1 row affected (" << (double) (endTime - startTime) / CLOCKS_PER_SEC << " sec)" << endl;
@@ -281,8 +354,10 @@ dberr_t ExecuteEngine::ExecuteDropDatabase(pSyntaxNode ast, ExecuteContext *cont
     string database_name = ast->val_;
     auto it = dbs_.find(database_name);
     if (it != dbs_.end()) {
-        dbs_.erase(database_name);
+        delete it->second;
+        dbs_.erase(it);
         remove(("./databases/" + database_name).c_str());
+        remove(DBStorageEngine::WarmUpFileName(database_name).c_str());
         endTime = clock();
         cout << "Query OK, 1 row affected (" << (double) (endTime - startTime) / CLOCKS_PER_SEC << " sec)" << endl;
         return DB_SUCCESS;
@@ -337,6 +412,9 @@ dberr_t ExecuteEngine::ExecuteUseDatabase(pSyntaxNode ast, ExecuteContext *conte
     auto it = dbs_.find(database_name);
     //找到
     if (it != dbs_.end()) {
+        if (it->second == nullptr) {
+            it->second = new DBStorageEngine(database_name, false, DEFAULT_BUFFER_POOL_SIZE, durability_, buffer_pool_);
+        }
         current_db_ = database_name;
         endTime = clock();
         cout << "Query OK (" << (double) (endTime - startTime) / CLOCKS_PER_SEC << " sec)" << endl;
@@ -541,6 +619,92 @@ dberr_t ExecuteEngine::ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *conte
     return DB_SUCCESS;
 }
 
+/**
+ * Buffer pool counters of the current database: one row for the whole pool, then one per table and index that has
+ * touched it since the database was opened.
+ */
+dberr_t ExecuteEngine::ExecuteShowBufferStatus(pSyntaxNode ast, ExecuteContext *context) {
+    clock_t startTime, endTime;
+    startTime = clock();
+    auto it = dbs_.find(current_db_);
+    if (it == dbs_.end()) return DB_NOT_EXIST;
+    BufferPoolManager *bpm = it->second->bpm_;
+    BufferPoolStats pool_stats = bpm->GetStats();
+    map<string, BufferPoolStats> owner_stats = bpm->GetOwnerStats();
+
+    vector<string> header{"object", "fetches", "hits", "misses", "hit ratio", "evictions", "dirty writes",
+                          "new page failures", "pinned", "pinned peak"};
+    auto make_row = [](const string &object, const BufferPoolStats &stats, bool whole_pool) {
+        std::stringstream ratio;
+        ratio << fixed << setprecision(2) << stats.HitRatio() * 100 << "%";
+        return vector<string>{object, to_string(stats.fetches_), to_string(stats.hits_), to_string(stats.misses_),
+                              ratio.str(), to_string(stats.evictions_), to_string(stats.dirty_writes_),
+                              to_string(stats.new_page_failures_),
+                              whole_pool ? to_string(stats.pinned_frames_) : "-",
+                              whole_pool ? to_string(stats.pinned_high_water_) : "-"};
+    };
+    vector<vector<string>> rows;
+    rows.push_back(make_row("buffer pool", pool_stats, true));
+    for (auto &owner : owner_stats) {
+        rows.push_back(make_row(owner.first, owner.second, false));
+    }
+
+    vector<int> width;
+    for (auto &cell : header) {
+        width.push_back(cell.length());
+    }
+    for (auto &row : rows) {
+        for (size_t i = 0; i < row.size(); i++) {
+            width[i] = max(width[i], static_cast<int>(row[i].length()));
+        }
+    }
+    std::stringstream ss;
+    ResultWriter show(ss);
+    show.Divider(width);
+    show.BeginRow();
+    for (size_t i = 0; i < header.size(); i++) {
+        show.WriteHeaderCell(header[i], width[i]);
+    }
+    show.EndRow();
+    show.Divider(width);
+    for (auto &row : rows) {
+        show.BeginRow();
+        for (size_t i = 0; i < row.size(); i++) {
+            show.WriteCell(row[i], width[i]);
+        }
+        show.EndRow();
+    }
+    show.Divider(width);
+    std::cout << show.stream_.rdbuf();
+    endTime = clock();
+    std::cout << rows.size() << "rows in set(" << (double) (endTime - startTime) / CLOCKS_PER_SEC << " sec)" << endl;
+    return DB_SUCCESS;
+}
+
+/**
+ * Resize the buffer pool shared by all open databases to the given number of frames while it stays in use.
+ */
+dberr_t ExecuteEngine::ExecuteSetBufferPool(pSyntaxNode ast, ExecuteContext *context) {
+    clock_t startTime, endTime;
+    startTime = clock();
+    auto it = dbs_.find(current_db_);
+    if (it == dbs_.end()) return DB_NOT_EXIST;
+    string size_text = ast->child_->val_;
+    if (size_text.find_first_not_of("0123456789") != string::npos || stoul(size_text) == 0) {
+        cout << "Buffer pool size must be a positive number of pages." << endl;
+        return DB_FAILED;
+    }
+    size_t requested = stoul(size_text);
+    size_t resized = it->second->bpm_->ResizePool(requested);
+    endTime = clock();
+    if (resized != requested) {
+        cout << "Buffer pool stopped at " << resized << " pages, the remaining frames are in use." << endl;
+    }
+    cout << "Query OK, buffer pool is " << resized << " pages (" << (double) (endTime - startTime) / CLOCKS_PER_SEC
+         << " sec)" << endl;
+    return DB_SUCCESS;
+}
+
 /**
  * TODO: Student Implement
  */
@@ -604,6 +768,41 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context
     return DB_SUCCESS;
 }
 
+/**
+ * Remove the deleted rows of one table, or of every table of the current database, for good and give the pages they
+ * leave empty back.
+ */
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context) {
+    clock_t startTime, endTime;
+    startTime = clock();
+    auto it = dbs_.find(current_db_);
+    if (it == dbs_.end()) return DB_NOT_EXIST;
+    CatalogManager *catalog = it->second->catalog_mgr_;
+    vector<string> table_names;
+    if (ast->child_ != nullptr) {
+        table_names.emplace_back(ast->child_->val_);
+    } else {
+        vector<TableInfo *> tables;
+        catalog->GetTables(tables);
+        for (auto table: tables) {
+            table_names.push_back(table->GetTableName());
+        }
+    }
+    uint32_t removed_rows = 0;
+    uint32_t freed_pages = 0;
+    for (auto &table_name: table_names) {
+        uint32_t table_removed_rows = 0;
+        uint32_t table_freed_pages = 0;
+        dberr_t result = catalog->VacuumTable(table_name, nullptr, table_removed_rows, table_freed_pages);
+        if (result != DB_SUCCESS) return result;
+        removed_rows += table_removed_rows;
+        freed_pages += table_freed_pages;
+    }
+    endTime = clock();
+    cout << "Query OK, " << removed_rows << " deleted rows removed, " << freed_pages << " pages freed ("
+         << (double) (endTime - startTime) / CLOCKS_PER_SEC << " sec)" << endl;
+    return DB_SUCCESS;
+}
 
 dberr_t ExecuteEngine::ExecuteTrxBegin(pSyntaxNode ast, ExecuteContext *context) {
 #ifdef ENABLE_EXECUTE_DEBUG
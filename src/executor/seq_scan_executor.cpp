@@ -20,7 +20,7 @@ void SeqScanExecutor::Init() {
             throw MyException("SeqScanExecutor init failed, table not found");
         }
         table_heap_ = table_info_->GetTableHeap();
-        table_iterator_ = table_heap_->Begin(exec_ctx_->GetTransaction());
+        table_iterator_ = table_heap_->Begin(exec_ctx_->GetTransaction(), &scan_strategy_);
         is_init = true;
     }
 }
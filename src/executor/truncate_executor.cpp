@@ -0,0 +1,20 @@
+#include "executor/executors/truncate_executor.h"
+
+TruncateExecutor::TruncateExecutor(ExecuteContext *exec_ctx, const TruncatePlanNode *plan)
+        : AbstractExecutor(exec_ctx), plan_(plan) {}
+
+void TruncateExecutor::Init() {
+    removed_rows_ = 0;
+    if (exec_ctx_->GetCatalog()->TruncateTable(plan_->GetTableName(), exec_ctx_->GetTransaction(), removed_rows_) !=
+        DB_SUCCESS) {
+        throw MyException("TruncateExecutor init failed, table not found");
+    }
+}
+
+bool TruncateExecutor::Next([[maybe_unused]] Row *row, [[maybe_unused]] RowId *rid) {
+    if (removed_rows_ == 0) {
+        return false;
+    }
+    removed_rows_--;
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef MINISQL_BUFFER_ACCESS_STRATEGY_H
+#define MINISQL_BUFFER_ACCESS_STRATEGY_H
+
+#include <vector>
+
+#include "common/config.h"
+#include "page/page.h"
+
+/**
+ * BufferAccessStrategy is a small private ring of frames that a bulk sequential reader (table scans, index builds,
+ * dropping a table) passes to BufferPoolManager::FetchPage. A page that misses the pool is read into the ring's next
+ * frame once that frame is unpinned again, instead of evicting the replacer's victim, so one scan only ever occupies
+ * ring_size frames and leaves the rest of the pool (e.g. hot B+ tree pages) alone. Pages that are already resident are
+ * used in place.
+ *
+ * A strategy belongs to one reader and is not thread safe.
+ */
+class BufferAccessStrategy {
+ public:
+  explicit BufferAccessStrategy(size_t ring_size = SCAN_RING_SIZE) : ring_(ring_size == 0 ? 1 : ring_size, nullptr) {}
+
+  /** @return the frame the next miss should be read into, nullptr while the ring is still filling up */
+  Page *Current() const { return ring_[current_]; }
+
+  /** Put the frame a miss was just read into at the current ring position and move on */
+  void Remember(Page *frame) {
+    ring_[current_] = frame;
+    current_ = current_ + 1 == ring_.size() ? 0 : current_ + 1;
+  }
+
+  size_t GetRingSize() const { return ring_.size(); }
+
+ private:
+  std::vector<Page *> ring_;
+  size_t current_{0};
+};
+
+#endif  // MINISQL_BUFFER_ACCESS_STRATEGY_H
@@ -1,58 +1,359 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
+#include <map>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_guard.h"
 #include "page/disk_file_meta_page.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
 
 using namespace std;
 
+/**
+ * Who wrote dirty pages back, see BufferPoolManager::GetWriteStats
+ */
+struct BufferPoolWriteStats {
+  uint64_t background_writes_{0};  // dirty pages written ahead of eviction by the background writer
+  uint64_t eviction_writes_{0};    // dirty victims written by the thread that needed their frame
+};
+
 class BufferPoolManager {
+  friend class ParallelBufferPoolManager;
+  friend class DatabaseBufferPoolManager;
+
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager,
+                             ReplacerType replacer_type = ReplacerType::kLRU);
+
+  virtual ~BufferPoolManager();
 
-  ~BufferPoolManager();
+  /**
+   * @param strategy if set, a miss is read into the strategy's ring instead of evicting the replacer's victim
+   */
+  virtual Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
-  Page *FetchPage(page_id_t page_id);
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty);
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  virtual bool FlushPage(page_id_t page_id);
 
-  bool FlushPage(page_id_t page_id);
+  virtual Page *NewPage(page_id_t &page_id);
 
-  Page *NewPage(page_id_t &page_id);
+  virtual bool DeletePage(page_id_t page_id);
 
-  bool DeletePage(page_id_t page_id);
+  /**
+   * FetchPage wrapped in a guard that unpins the page when it goes out of scope. The guard is empty if the page could
+   * not be fetched.
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
-  bool IsPageFree(page_id_t page_id);
+  /** FetchPage wrapped in a guard that also holds the page's read latch */
+  ReadPageGuard FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
 
-  bool CheckAllUnpinned();
+  /** FetchPage wrapped in a guard that also holds the page's write latch */
+  WritePageGuard FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /** NewPage wrapped in a write guard, a new page is always unpinned dirty */
+  WritePageGuard NewPageGuarded(page_id_t &page_id);
+
+  /**
+   * Start reading page_id into a frame in the background without pinning it, a later FetchPage of the page waits for
+   * the read instead of issuing its own. Does nothing if the page is resident or already being read, or if no frame
+   * can be freed.
+   * @param strategy if set, the page is read into the strategy's ring
+   */
+  virtual void PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Prefetch the count pages first_page_id, first_page_id + 1, ...
+   */
+  void PrefetchRange(page_id_t first_page_id, size_t count, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * @return whether a prefetch of page_id is still waiting for its read, fetching such a page would block
+   */
+  virtual bool IsPageLoading(page_id_t page_id);
+
+  virtual bool IsPageFree(page_id_t page_id);
+
+  /** @return the number of frames of the pool */
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  /**
+   * Grow or shrink the pool while it is in use. Growing adds free frames. Shrinking evicts the pages of the frames past
+   * the new size, writing dirty ones back, and gives their memory back a chunk at a time. It stops early at a frame
+   * that is pinned or still being read.
+   * @return the pool size reached
+   */
+  virtual size_t ResizePool(size_t pool_size);
+
+  /**
+   * @return the ids of the resident pages, hottest first: pinned pages, then the others in reverse replacement order
+   */
+  virtual vector<page_id_t> GetHotPages();
+
+  /**
+   * Write GetHotPages() to path so that a later StartWarmUp can read the same pages back in, called on clean shutdown.
+   * @return false if the file could not be written
+   */
+  bool SaveWarmUpList(const string &path);
+
+  /**
+   * Prefetch the pages named by a SaveWarmUpList file, as many of the hottest as the pool holds, in page id order. The
+   * reads run on the prefetcher thread, so the pool serves requests while it warms up. The file is removed once read,
+   * a missing or malformed file is ignored.
+   * @return the number of pages queued for reading
+   */
+  size_t StartWarmUp(const string &path);
+
+  virtual bool CheckAllUnpinned();
+
+  /**
+   * Start a thread that writes unpinned dirty pages back in page id order before they are chosen as victims, so
+   * FetchPage and NewPage find clean frames and do not pay for a synchronous write.
+   * @param clean_target clean evictable frames the writer tries to keep ready, it idles while there are enough
+   * @param max_writes_per_round most pages written per round, together with interval_ms this caps the write rate
+   * @param interval_ms pause between rounds
+   */
+  virtual void StartBackgroundWriter(size_t clean_target = BGWRITER_CLEAN_FRAMES,
+                                     size_t max_writes_per_round = BGWRITER_MAX_PAGES,
+                                     uint32_t interval_ms = BGWRITER_INTERVAL_MS);
+
+  virtual void StopBackgroundWriter();
+
+  virtual BufferPoolWriteStats GetWriteStats();
+
+  /**
+   * @return fetches, hits, misses, evictions, dirty victim writes and NewPage failures since the last ResetStats, and
+   * the current and highest number of pinned frames
+   */
+  virtual BufferPoolStats GetStats();
+
+  virtual void ResetStats();
+
+  /**
+   * @return the counters accesses made under a BufferPoolStatsScope for owner are attributed to, created on first use
+   * and kept for the life of the pool. Owners are named "table <name>" and "index <table>.<name>" by the catalog.
+   */
+  BufferPoolCounters *GetOwnerCounters(const string &owner);
+
+  /** @return a snapshot of every owner's counters, by owner name */
+  map<string, BufferPoolStats> GetOwnerStats();
+
+  /**
+   * Let the pool cache pages of another database file next to its own, which is file 0. Pages are kept under their
+   * (file, page id) pair, so the files share frames and the replacer treats them alike. A DatabaseBufferPoolManager
+   * gives access to one attached file.
+   * @return the id of the file inside the pool
+   */
+  virtual file_id_t AttachFile(DiskManager *disk_manager);
+
+  /**
+   * Write back and drop every page of the file, its disk manager is not used afterwards
+   */
+  virtual void DetachFile(file_id_t file_id);
+
+ protected:
+  /**
+   * Used by pools that only dispatch to other instances and own no frames themselves
+   */
+  explicit BufferPoolManager(DiskManager *disk_manager) : disk_manager_(disk_manager) {}
 
  private:
+  /** A page of one of the attached files, the key of the page table */
+  using page_key_t = uint64_t;
+
+  static page_key_t PageKey(file_id_t file_id, page_id_t page_id) {
+    return (static_cast<page_key_t>(file_id) << 32) | static_cast<uint32_t>(page_id);
+  }
+
+  static page_key_t FrameKey(const Page *frame) { return PageKey(frame->file_id_, frame->page_id_); }
+
+  DiskManager *Disk(file_id_t file_id) const { return files_[file_id]; }
+
+  /*
+   * The operations of the public interface for a page of any attached file, the public ones work on file 0. They are
+   * virtual so that a DatabaseBufferPoolManager can share a ParallelBufferPoolManager as well.
+   */
+  virtual Page *FetchFilePage(file_id_t file_id, page_id_t page_id, BufferAccessStrategy *strategy);
+
+  virtual bool UnpinFilePage(file_id_t file_id, page_id_t page_id, bool is_dirty);
+
+  virtual bool FlushFilePage(file_id_t file_id, page_id_t page_id);
+
+  virtual Page *NewFilePage(file_id_t file_id, page_id_t &page_id);
+
+  virtual bool DeleteFilePage(file_id_t file_id, page_id_t page_id);
+
+  virtual void PrefetchFilePage(file_id_t file_id, page_id_t page_id, BufferAccessStrategy *strategy);
+
+  virtual bool IsFilePageLoading(file_id_t file_id, page_id_t page_id);
+
+  virtual bool CheckFileUnpinned(file_id_t file_id);
+
+  virtual vector<page_id_t> GetFileHotPages(file_id_t file_id);
+
   /**
    * Allocate new page (operations like create index/table) For now just keep an increasing counter
    */
-  page_id_t AllocatePage();
+  page_id_t AllocatePage(file_id_t file_id);
 
   /**
    * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
    */
-  void DeallocatePage(page_id_t page_id);
+  void DeallocatePage(file_id_t file_id, page_id_t page_id);
 
+  /**
+   * Take a frame from the free list, or evict the replacer's victim and drop it from the page table.
+   * The victim's old page id and contents are left in the frame so the caller can write them back.
+   * @return INVALID_FRAME_ID if every frame is pinned
+   */
   frame_id_t TryToFindFreePage();
 
+  /**
+   * Take back the strategy's current ring frame if it belongs to this pool, holds a page and is unpinned.
+   * @return INVALID_FRAME_ID if the ring frame cannot be recycled
+   */
+  frame_id_t TryToReuseRingFrame(BufferAccessStrategy *strategy);
+
+  /**
+   * A frame for a page that misses the pool: the strategy's ring frame if it can be recycled, otherwise a free frame or
+   * the replacer's victim. The frame is remembered in the strategy's ring.
+   */
+  frame_id_t AcquireFrame(BufferAccessStrategy *strategy);
+
+  /**
+   * Block until a prefetch of page_id, if any, has landed in its frame
+   */
+  void WaitForLoad(unique_lock<recursive_mutex> &lock, page_key_t key);
+
+  void PrefetchLoop();
+
+  void StopPrefetcher();
+
+  /**
+   * Like NewFilePage, but for a page id that the caller already allocated on disk
+   */
+  Page *NewFilePageWithId(file_id_t file_id, page_id_t page_id);
+
+  /**
+   * Put a new, zeroed and pinned page into frame_id, writing back the dirty page it held before
+   * @return nullptr if the old page could not be written back
+   */
+  Page *InstallNewPage(frame_id_t frame_id, file_id_t file_id, page_id_t page_id);
+
+  /**
+   * Write back the dirty page held by frame and read new_page_id into it, overlapping both when the disk manager
+   * has asynchronous I/O. If the write fails the frame still holds the old page.
+   * @param[out] written whether the old page reached the disk
+   * @return whether the new page was read
+   */
+  bool ReplaceDirtyFrame(Page *frame, file_id_t file_id, page_id_t new_page_id, bool &written);
+
+  /**
+   * Write back the dirty page of a frame just taken for another page. If that fails the page is put back into the
+   * page table and the replacer, so its changes stay in memory until a later write-back succeeds.
+   * @return false if the frame still holds its old page
+   */
+  bool WriteBackVictim(frame_id_t frame_id);
+
+  /** Make a frame whose page was taken out of it again evictable, still dirty */
+  void RestoreVictim(frame_id_t frame_id);
+
+  /** Put a frame back on the free list, e.g. after the page meant for it could not be read */
+  void DiscardFrame(frame_id_t frame_id);
+
+  /**
+   * Forget a page that leaves the page table
+   */
+  void RemoveFromPageTable(page_key_t key);
+
+  /** Bump one counter of the pool and of the owner the calling thread works for */
+  static void Count(BufferPoolCounters &counters, atomic<uint64_t> BufferPoolCounters::*counter) {
+    (counters.*counter).fetch_add(1, memory_order_relaxed);
+    BufferPoolCounters *owner = BufferPoolStatsScope::Current();
+    if (owner != nullptr) {
+      (owner->*counter).fetch_add(1, memory_order_relaxed);
+    }
+  }
+
+  /** A frame went from unpinned to pinned */
+  void OnFramePinned() {
+    if (++pinned_frames_ > pinned_high_water_) {
+      pinned_high_water_ = pinned_frames_;
+    }
+  }
+
+  /** @return the frame with frame_id, frames live in chunks so that growing the pool never moves a page */
+  Page *Frame(frame_id_t frame_id) const { return &chunks_[frame_id / chunk_frames_][frame_id % chunk_frames_]; }
+
+  /** @return the id of frame, INVALID_FRAME_ID if it is not a frame of the pool (any more) */
+  frame_id_t FrameIdOf(const Page *frame) const;
+
+  /**
+   * Evict the page of an unused frame ahead of a shrink
+   * @return false if the frame is pinned or being read
+   */
+  bool ReleaseFrame(frame_id_t frame_id);
+
+  void BackgroundWriterLoop();
+
+  /**
+   * One background writer round, the latch is only held for one page write at a time
+   * @return number of pages written
+   */
+  size_t BackgroundWriterRound();
+
  private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
+  size_t pool_size_{0};                              // number of pages in buffer pool
+  size_t chunk_frames_{1};                           // frames per chunk
+  vector<Page *> chunks_;                            // frame arrays, frame i is in chunk i / chunk_frames_
   DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-  Replacer *replacer_;                               // to find an unpinned page for replacement
+  vector<DiskManager *> files_;                      // attached files by file id, disk_manager_ is file 0
+  unordered_map<page_key_t, frame_id_t> page_table_;  // to keep track of pages
+  Replacer *replacer_{nullptr};                      // to find an unpinned page for replacement
   list<frame_id_t> free_list_;                       // to find a free page for replacement
   recursive_mutex latch_;                            // to protect shared data structure
+  set<page_key_t> dirty_pages_;                      // resident dirty pages, in file and page id order
+
+  thread bgwriter_;
+  mutex bgwriter_latch_;
+  condition_variable bgwriter_cv_;
+  bool bgwriter_stop_{false};
+  size_t bgwriter_clean_target_{0};
+  size_t bgwriter_max_writes_{0};
+  uint32_t bgwriter_interval_ms_{0};
+  page_key_t bgwriter_cursor_{0};  // the next round continues after the last page written
+  atomic<uint64_t> background_writes_{0};
+  atomic<uint64_t> eviction_writes_{0};
+
+  unordered_set<page_key_t> loading_pages_;             // prefetched pages whose read has not completed yet
+  deque<pair<page_key_t, frame_id_t>> prefetch_queue_;  // prefetches not yet handed to the disk manager
+  condition_variable_any prefetch_cv_;                 // wakes the prefetch thread
+  condition_variable_any load_cv_;                     // signalled whenever prefetched pages land
+  thread prefetcher_;
+  bool prefetch_stop_{false};
+
+  BufferPoolCounters counters_;
+  size_t pinned_frames_{0};
+  size_t pinned_high_water_{0};
+  mutex owner_latch_;  // protects owner_counters_, the counters themselves are atomic
+  map<string, unique_ptr<BufferPoolCounters>> owner_counters_;
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
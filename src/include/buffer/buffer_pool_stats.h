@@ -0,0 +1,95 @@
+#ifndef MINISQL_BUFFER_POOL_STATS_H
+#define MINISQL_BUFFER_POOL_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Access counters of a buffer pool, or of the part of its traffic one table or index caused. They are bumped with
+ * relaxed atomics and are only meant to be read as a BufferPoolStats snapshot.
+ */
+struct BufferPoolCounters {
+  std::atomic<uint64_t> fetches_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};          // resident pages pushed out to make room
+  std::atomic<uint64_t> dirty_writes_{0};       // evicted pages that had to be written first
+  std::atomic<uint64_t> new_page_failures_{0};  // NewPage calls that found every frame pinned
+
+  void Reset() {
+    fetches_ = 0;
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+    dirty_writes_ = 0;
+    new_page_failures_ = 0;
+  }
+};
+
+/**
+ * A snapshot of BufferPoolCounters, see BufferPoolManager::GetStats and BufferPoolManager::GetOwnerStats
+ */
+struct BufferPoolStats {
+  BufferPoolStats() = default;
+
+  explicit BufferPoolStats(const BufferPoolCounters &counters)
+      : fetches_(counters.fetches_.load(std::memory_order_relaxed)),
+        hits_(counters.hits_.load(std::memory_order_relaxed)),
+        misses_(counters.misses_.load(std::memory_order_relaxed)),
+        evictions_(counters.evictions_.load(std::memory_order_relaxed)),
+        dirty_writes_(counters.dirty_writes_.load(std::memory_order_relaxed)),
+        new_page_failures_(counters.new_page_failures_.load(std::memory_order_relaxed)) {}
+
+  /** @return hits / fetches, 0 before the first fetch */
+  double HitRatio() const { return fetches_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(fetches_); }
+
+  BufferPoolStats &operator+=(const BufferPoolStats &other) {
+    fetches_ += other.fetches_;
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    evictions_ += other.evictions_;
+    dirty_writes_ += other.dirty_writes_;
+    new_page_failures_ += other.new_page_failures_;
+    pinned_frames_ += other.pinned_frames_;
+    pinned_high_water_ += other.pinned_high_water_;
+    return *this;
+  }
+
+  uint64_t fetches_{0};
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  uint64_t evictions_{0};
+  uint64_t dirty_writes_{0};
+  uint64_t new_page_failures_{0};
+  uint64_t pinned_frames_{0};      // frames pinned right now, whole pool only
+  uint64_t pinned_high_water_{0};  // most frames pinned at once since the last reset, whole pool only
+};
+
+/**
+ * While a BufferPoolStatsScope is alive, every buffer pool access of its thread is also counted in the counters it was
+ * given. TableHeap, its iterators and BPlusTreeIndex open one per operation, which is how the pool's traffic is broken
+ * down per table and index. A scope without counters keeps the enclosing scope's.
+ */
+class BufferPoolStatsScope {
+ public:
+  explicit BufferPoolStatsScope(BufferPoolCounters *counters) : previous_(current_) {
+    if (counters != nullptr) {
+      current_ = counters;
+    }
+  }
+
+  ~BufferPoolStatsScope() { current_ = previous_; }
+
+  BufferPoolStatsScope(const BufferPoolStatsScope &) = delete;
+
+  BufferPoolStatsScope &operator=(const BufferPoolStatsScope &) = delete;
+
+  /** @return the counters accesses of this thread are attributed to, nullptr outside of any scope */
+  static BufferPoolCounters *Current() { return current_; }
+
+ private:
+  static inline thread_local BufferPoolCounters *current_{nullptr};
+  BufferPoolCounters *previous_;
+};
+
+#endif  // MINISQL_BUFFER_POOL_STATS_H
@@ -1,26 +1,23 @@
-
 #ifndef MINISQL_CLOCK_REPLACER_H
 #define MINISQL_CLOCK_REPLACER_H
 
-#include <mutex>
+#include <cstdint>
 #include <vector>
-#include <algorithm>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
 
 using namespace std;
 
-class ClockReplacer: public Replacer {
- private:
-  /**
-   * @brief state of the frame
-   * if pin -> EMPTY
-   * if unpin -> ACCESSED
-   * after ACCESSED -> UNUSED
-   */
-  enum class State { EMPTY, ACCESSED, UNUSED };
-
+/**
+ * ClockReplacer implements the clock (second chance) policy.
+ *
+ * Every frame has a reference bit and an evictable bit, packed 64 to a word. The hand keeps its position between
+ * calls: it clears the reference bit of every evictable frame it passes and evicts the first evictable frame whose bit
+ * is already clear. Words without any evictable frame are skipped whole, so a Victim call is O(1) amortized and the
+ * evictable count is maintained instead of recomputed.
+ */
+class ClockReplacer : public Replacer {
  public:
   /**
    * Create a new ClockReplacer.
@@ -39,15 +36,36 @@ class ClockReplacer: public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
+  size_t PinSize() override;
+
+  size_t UnpinSize() override;
+
+  vector<frame_id_t> HotFrames() override;
+
+  void Resize(size_t num_pages) override;
+
  private:
-  static bool IsEmpty(ClockReplacer::State &);
+  static bool TestBit(const vector<uint64_t> &bits, size_t pos) { return (bits[pos >> 6] >> (pos & 63)) & 1; }
+
+  static void SetBit(vector<uint64_t> &bits, size_t pos) { bits[pos >> 6] |= uint64_t{1} << (pos & 63); }
+
+  static void ClearBit(vector<uint64_t> &bits, size_t pos) { bits[pos >> 6] &= ~(uint64_t{1} << (pos & 63)); }
+
+  /** Move the hand one frame forward, wrapping around */
+  void Advance() { hand_ = hand_ + 1 == capacity_ ? 0 : hand_ + 1; }
 
  private:
-  std::vector<State> second_chance;
-  frame_id_t pointer{0};
-  size_t capacity;
+  vector<uint64_t> reference_bits_;
+  vector<uint64_t> evictable_bits_;
+  vector<uint64_t> pinned_bits_;  // frames the buffer pool currently has pinned
+  size_t capacity_;
+  size_t hand_{0};
+  size_t evictable_size_{0};
+  size_t pinned_size_{0};
 };
 
 #endif  // MINISQL_CLOCK_REPLACER_H
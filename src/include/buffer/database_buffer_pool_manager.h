@@ -0,0 +1,78 @@
+#ifndef MINISQL_DATABASE_BUFFER_POOL_MANAGER_H
+#define MINISQL_DATABASE_BUFFER_POOL_MANAGER_H
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * DatabaseBufferPoolManager is one database's view of a buffer pool shared by every open database. It attaches the
+ * database file to the shared pool and forwards page requests for that file, so the databases compete for the same
+ * frames and an idle database's pages are evicted in favour of a busy one's instead of each holding a fixed pool of
+ * its own. Per table and per index counters stay with the view.
+ */
+class DatabaseBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param pool the shared pool, it must outlive the view
+   */
+  DatabaseBufferPoolManager(BufferPoolManager *pool, DiskManager *disk_manager);
+
+  /**
+   * Writes back and drops the database's pages, the frames go back to the shared pool.
+   */
+  ~DatabaseBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  void PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+  bool IsPageLoading(page_id_t page_id) override;
+
+  /** @return the size of the shared pool */
+  size_t GetPoolSize() override;
+
+  /**
+   * Resizes the shared pool, which affects every open database.
+   */
+  size_t ResizePool(size_t pool_size) override;
+
+  /**
+   * The hottest pages of this database only.
+   */
+  vector<page_id_t> GetHotPages() override;
+
+  /** @return whether every page of this database is unpinned */
+  bool CheckAllUnpinned() override;
+
+  /**
+   * The shared pool runs one writer for all databases, a view does not start its own.
+   */
+  void StartBackgroundWriter(size_t, size_t, uint32_t) override {}
+
+  void StopBackgroundWriter() override {}
+
+  BufferPoolWriteStats GetWriteStats() override;
+
+  /** @return the shared pool's counters */
+  BufferPoolStats GetStats() override;
+
+  /**
+   * Resets the shared pool's counters and this database's table and index counters.
+   */
+  void ResetStats() override;
+
+  file_id_t GetFileId() const { return file_id_; }
+
+ private:
+  BufferPoolManager *pool_;
+  file_id_t file_id_;
+};
+
+#endif  // MINISQL_DATABASE_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,82 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <deque>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin is an access. The replacer keeps the last K access timestamps of each frame and evicts the evictable frame
+ * whose K-th most recent access is the oldest (largest backward K-distance). Frames with fewer than K accesses have an
+ * infinite K-distance and go first, oldest first access first, so pages touched once by a scan leave before hot pages
+ * such as B+ tree internal nodes.
+ *
+ * Timestamps are a logical clock advanced on every access. An access that comes within correlated_period ticks of the
+ * frame's previous access is treated as part of the same reference (e.g. a scan re-pinning the page for each tuple) and
+ * only refreshes the latest timestamp instead of adding a new one.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * @param num_pages the maximum number of frames the replacer will be required to store
+   * @param k number of accesses remembered per frame
+   * @param correlated_period accesses closer than this many ticks to the previous one count as the same reference
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        uint64_t correlated_period = LRUK_CORRELATED_PERIOD);
+
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  size_t PinSize() override;
+
+  size_t UnpinSize() override;
+
+  vector<frame_id_t> HotFrames() override;
+
+  void Resize(size_t num_pages) override;
+
+ private:
+  struct FrameEntry {
+    deque<uint64_t> history_;  // most recent access at the back, at most k_ entries
+    bool tracked_{false};
+    bool evictable_{false};
+  };
+
+  /** Record an access to frame_id at the current time */
+  void RecordAccess(FrameEntry &entry);
+
+  /** Ordering key of an evictable frame inside its eviction set */
+  uint64_t EvictionKey(const FrameEntry &entry) const;
+
+  /** The eviction set an evictable frame belongs to: fewer than k_ accesses or a full history */
+  set<pair<uint64_t, frame_id_t>> &EvictionSet(const FrameEntry &entry);
+
+ private:
+  vector<FrameEntry> frames_;
+  set<pair<uint64_t, frame_id_t>> history_list_;  // evictable frames with fewer than k_ accesses, by first access
+  set<pair<uint64_t, frame_id_t>> cache_list_;    // evictable frames with k_ accesses, by k-th most recent access
+  size_t k_;
+  uint64_t correlated_period_;
+  uint64_t current_timestamp_{0};
+  size_t pin_size_{0};
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
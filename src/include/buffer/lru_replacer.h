@@ -3,6 +3,7 @@
 
 #include <list>
 #include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -32,17 +33,24 @@ class LRUReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void Remove(frame_id_t frame_id) override;
+
   size_t Size() override;
 
   size_t PinSize() override;
 
   size_t UnpinSize() override;
 
+  vector<frame_id_t> HotFrames() override;
+
+  void Resize(size_t num_pages) override;
+
  private:
   // add your own private member variables here
   list<frame_id_t> lru_unpin_list;
   unordered_set<frame_id_t> lru_pin_set;
-  unordered_set<frame_id_t> lru_unpin_set;
+  /** position of every evictable frame inside lru_unpin_list, so Pin does not scan the list */
+  unordered_map<frame_id_t, list<frame_id_t>::iterator> lru_unpin_set;
   size_t max_pages;
 };
 
@@ -0,0 +1,140 @@
+#ifndef MINISQL_PAGE_GUARD_H
+#define MINISQL_PAGE_GUARD_H
+
+#include "page/page.h"
+
+class BufferPoolManager;
+
+/**
+ * BasicPageGuard owns one pin on a buffer pool page and gives it back when it goes out of scope, so no return path can
+ * leak the pin. Guards are move only: moving hands the pin over, and Drop() releases it early, e.g. before the page is
+ * deleted. The page is unpinned dirty once AsMut() or MarkDirty() has been called.
+ *
+ * A basic guard does not latch the page. ReadPageGuard and WritePageGuard additionally hold the page's read or write
+ * latch for as long as they own the pin. A thread must not take a second latching guard on a page it already guards.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  ~BasicPageGuard() { Drop(); }
+
+  /** Unpin the page now, the guard is empty afterwards */
+  void Drop();
+
+  /** @return whether the guard holds a page, false if the fetch it came from failed */
+  bool IsValid() const { return page_ != nullptr; }
+
+  explicit operator bool() const { return IsValid(); }
+
+  page_id_t PageId() const { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetPageId(); }
+
+  Page *GetPage() const { return page_; }
+
+  /** @return the page viewed as T, e.g. TablePage or BPlusTreeLeafPage, for reading */
+  template <class T>
+  T *As() const {
+    return reinterpret_cast<T *>(page_);
+  }
+
+  /** @return the page viewed as T for modification, the page is unpinned dirty */
+  template <class T>
+  T *AsMut() {
+    is_dirty_ = true;
+    return reinterpret_cast<T *>(page_);
+  }
+
+  void MarkDirty() { is_dirty_ = true; }
+
+ protected:
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds a pin and the read latch of a page.
+ */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /** Takes over the pin held by guard and latches the page for reading */
+  explicit ReadPageGuard(BasicPageGuard &&guard);
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Release the latch and the pin now */
+  void Drop();
+
+  bool IsValid() const { return guard_.IsValid(); }
+
+  explicit operator bool() const { return IsValid(); }
+
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds a pin and the write latch of a page.
+ */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /** Takes over the pin held by guard and latches the page for writing */
+  explicit WritePageGuard(BasicPageGuard &&guard);
+
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Release the latch and the pin now */
+  void Drop();
+
+  bool IsValid() const { return guard_.IsValid(); }
+
+  explicit operator bool() const { return IsValid(); }
+
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  template <class T>
+  T *As() const {
+    return guard_.As<T>();
+  }
+
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+  void MarkDirty() { guard_.MarkDirty(); }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+#endif  // MINISQL_PAGE_GUARD_H
@@ -0,0 +1,114 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into independent BufferPoolManager instances, each with its own
+ * latch, page table, free list and replacer. A page always lives in instance page_id % num_instances, so threads
+ * working on different pages rarely contend on the same latch. Attached files are attached to every instance under
+ * the same file id, so the pool can be shared by DatabaseBufferPoolManagers like a single instance.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param num_instances number of independent instances
+   * @param pool_size total number of frames, split evenly between the instances
+   * @param replacer_type replacement policy of every instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            ReplacerType replacer_type = ReplacerType::kLRU);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  /**
+   * The page id is allocated first, the page then goes to the instance it maps to.
+   * @return nullptr if that instance has no free frame
+   */
+  Page *NewPage(page_id_t &page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  void PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) override;
+
+  bool IsPageLoading(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  size_t GetPoolSize() override;
+
+  /**
+   * The new size is split evenly between the instances, each resizes on its own.
+   */
+  size_t ResizePool(size_t pool_size) override;
+
+  bool CheckAllUnpinned() override;
+
+  /**
+   * Every instance runs its own writer, the clean target and the write rate are split between them.
+   */
+  void StartBackgroundWriter(size_t clean_target = BGWRITER_CLEAN_FRAMES,
+                             size_t max_writes_per_round = BGWRITER_MAX_PAGES,
+                             uint32_t interval_ms = BGWRITER_INTERVAL_MS) override;
+
+  void StopBackgroundWriter() override;
+
+  BufferPoolWriteStats GetWriteStats() override;
+
+  /**
+   * The sum over all instances. The pinned high-water mark is the sum of the instances' marks, an upper bound of the
+   * pool's.
+   */
+  BufferPoolStats GetStats() override;
+
+  void ResetStats() override;
+
+  size_t GetNumInstances() const { return instances_.size(); }
+
+  /**
+   * Attaches the file to every instance, under the same id in all of them
+   */
+  file_id_t AttachFile(DiskManager *disk_manager) override;
+
+  void DetachFile(file_id_t file_id) override;
+
+ private:
+  Page *FetchFilePage(file_id_t file_id, page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool UnpinFilePage(file_id_t file_id, page_id_t page_id, bool is_dirty) override;
+
+  bool FlushFilePage(file_id_t file_id, page_id_t page_id) override;
+
+  /**
+   * The page id is allocated from the file first, the page then goes to the instance it maps to.
+   */
+  Page *NewFilePage(file_id_t file_id, page_id_t &page_id) override;
+
+  bool DeleteFilePage(file_id_t file_id, page_id_t page_id) override;
+
+  void PrefetchFilePage(file_id_t file_id, page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool IsFilePageLoading(file_id_t file_id, page_id_t page_id) override;
+
+  bool CheckFileUnpinned(file_id_t file_id) override;
+
+  /**
+   * The instances' lists interleaved, hottest pages of every instance first. GetHotPages uses it for file 0.
+   */
+  vector<page_id_t> GetFileHotPages(file_id_t file_id) override;
+
+  BufferPoolManager *GetInstance(page_id_t page_id) { return instances_[page_id % instances_.size()]; }
+
+ private:
+  std::vector<BufferPoolManager *> instances_;
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
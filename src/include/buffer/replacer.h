@@ -2,9 +2,15 @@
 #define MINISQL_REPLACER_H
 
 #include <cstdio>
+#include <vector>
 
 #include "common/config.h"
 
+/**
+ * Replacement policies a BufferPoolManager can be built with
+ */
+enum class ReplacerType { kLRU, kLRUK, kClock };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -33,10 +39,27 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Forget a frame whose page leaves it without an eviction, e.g. a deleted page or a reused ring frame. The frame is
+   * neither pinned nor evictable afterwards and the next page in it starts without any access history.
+   * @param frame_id the id of the frame to forget
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
   virtual size_t UnpinSize() = 0;
   virtual size_t PinSize() = 0;
+
+  /**
+   * @return the evictable frames, hottest first: the frame Victim would choose is the last one
+   */
+  virtual std::vector<frame_id_t> HotFrames() = 0;
+
+  /**
+   * Change the number of frames the replacer covers. Frames at or past num_pages are forgotten, pinned or not.
+   */
+  virtual void Resize(size_t num_pages) = 0;
 };
 
 #endif  // MINISQL_REPLACER_H
@@ -68,6 +68,9 @@ private:
 /**
  * Catalog manager
  *
+ * Opening an existing catalog only reads the names of its tables and indexes. A table's TableInfo and heap, and an
+ * index's IndexInfo and B+ tree, are loaded when they are first looked up, so opening a database does not depend on
+ * how much data it holds.
  */
 class CatalogManager {
 public:
@@ -80,31 +83,57 @@ public:
 
     dberr_t GetTable(const std::string &table_name, TableInfo *&table_info);
 
-    dberr_t GetTables(std::vector<TableInfo *> &tables) const;
+    dberr_t GetTables(std::vector<TableInfo *> &tables);
 
     dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                         const std::vector<std::string> &index_keys, Transaction *txn, IndexInfo *&index_info,
                         const string &index_type);
 
-    dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
+    dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info);
 
-    dberr_t GetTableIndexes(const std::string &table_name, std::vector<IndexInfo *> &indexes) const;
+    dberr_t GetTableIndexes(const std::string &table_name, std::vector<IndexInfo *> &indexes);
 
     dberr_t DropTable(const std::string &table_name);
 
     dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+    /**
+     * Remove the deleted rows of a table for good and give its empty pages back, see TableHeap::Vacuum
+     */
+    dberr_t VacuumTable(const std::string &table_name, Transaction *txn, uint32_t &removed_rows,
+                        uint32_t &freed_pages);
+
+    /**
+     * Remove every row of a table and empty its indexes, see TableHeap::Truncate and Index::Destroy
+     * @param[out] removed_rows number of rows the table held
+     */
+    dberr_t TruncateTable(const std::string &table_name, Transaction *txn, uint32_t &removed_rows);
+
+    /**
+     * Vacuum every loaded table with at least min_pending_deletes rows deleted since it was last vacuumed, tables
+     * that were never looked up are left alone
+     * @return number of rows removed
+     */
+    uint32_t VacuumLoadedTables(uint32_t min_pending_deletes);
+
 private:
     dberr_t DropTable(table_id_t table_id);
 
     dberr_t FlushCatalogMetaPage() const;
 
+    /**
+     * Write the table's metadata again if its heap got a new last page or free space map since it was last written
+     */
+    dberr_t FlushTableMetaPage(TableInfo *table_info) const;
+
     dberr_t LoadTable(const table_id_t table_id, const page_id_t page_id);
 
     dberr_t LoadIndex(const index_id_t index_id, const page_id_t page_id);
 
     dberr_t GetTable(const table_id_t table_id, TableInfo *&table_info);
 
+    dberr_t GetIndex(const index_id_t index_id, IndexInfo *&index_info);
+
 private:
     [[maybe_unused]] BufferPoolManager *buffer_pool_manager_;
     [[maybe_unused]] LockManager *lock_manager_;
@@ -112,10 +141,10 @@ private:
     CatalogMeta *catalog_meta_;
     std::atomic<table_id_t> next_table_id_;
     std::atomic<index_id_t> next_index_id_;
-    // map for tables
+    // map for tables, tables_ only holds the tables loaded so far
     std::unordered_map<std::string, table_id_t> table_names_;
     std::unordered_map<table_id_t, TableInfo *> tables_;
-    // map for indexes: table_name->index_name->indexes
+    // map for indexes: table_name->index_name->indexes, indexes_ only holds the indexes loaded so far
     std::unordered_map<std::string, std::unordered_map<std::string, index_id_t>> index_names_;
     std::unordered_map<index_id_t, IndexInfo *> indexes_;
 };
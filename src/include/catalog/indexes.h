@@ -15,7 +15,8 @@ class IndexMetadata {
 
  public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map,
+                               KeyEncoding key_encoding = KeyEncoding::kMemcomparable);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,18 +34,25 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  /** @return how the index lays out its keys, indexes written before keys were memcomparable keep the row layout */
+  inline KeyEncoding GetKeyEncoding() const { return key_encoding_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map,
+                         KeyEncoding key_encoding = KeyEncoding::kMemcomparable);
 
  private:
   static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
+  static constexpr uint32_t INDEX_METADATA_MEMCOMPARABLE_MAGIC_NUM = 344530;
+  static constexpr uint32_t INDEX_METADATA_INT32_MAGIC_NUM = 344531;
   index_id_t index_id_;
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  KeyEncoding key_encoding_;      /** Recorded by the magic number */
 };
 
 /**
@@ -79,6 +87,8 @@ class IndexInfo {
     index_ = nullptr;
     index_ = CreateIndex(buffer_pool_manager, btree_type);
     ASSERT(index_ != nullptr, "nani");
+    index_->SetBufferPoolCounters(buffer_pool_manager->GetOwnerCounters("index " + table_info->GetTableName() + "." +
+                                                                        meta_data->GetIndexName()));
   }
 
   inline Index *GetIndex() { return index_; }
@@ -23,7 +23,8 @@ public:
      * will create new table schema and owned by mem heap
      */
     static TableMetadata *Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                                 TableSchema *schema);
+                                 TableSchema *schema, page_id_t last_page_id = INVALID_PAGE_ID,
+                                 page_id_t free_space_map_page_id = INVALID_PAGE_ID);
 
     inline table_id_t GetTableId() const { return table_id_; }
 
@@ -33,17 +34,26 @@ public:
 
     inline Schema *GetSchema() const { return schema_; }
 
+    inline page_id_t GetLastPageId() const { return last_page_id_; }
+
+    inline page_id_t GetFreeSpaceMapPageId() const { return free_space_map_page_id_; }
+
 public:
     TableMetadata() = delete;
 
-    TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+    TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                  page_id_t last_page_id = INVALID_PAGE_ID, page_id_t free_space_map_page_id = INVALID_PAGE_ID);
 
 public:
     static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+    // metadata that also records the heap's last page and free space map, written from now on
+    static constexpr uint32_t TABLE_METADATA_WITH_HEAP_PAGES_MAGIC_NUM = 344529;
     table_id_t table_id_;
     std::string table_name_;
     page_id_t root_page_id_;
     Schema *schema_;
+    page_id_t last_page_id_;            // a hint, the heap follows the chain from here when it is opened
+    page_id_t free_space_map_page_id_;
 };
 
 /**
@@ -73,6 +83,8 @@ public:
 
     inline page_id_t GetRootPageId() const { return table_meta_->root_page_id_; }
 
+    inline TableMetadata *GetTableMetadata() const { return table_meta_; }
+
 private:
     explicit TableInfo() {};
 
@@ -15,6 +15,24 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index
 
 static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 1;  // buffer pool shards, more than one selects the parallel pool
+static constexpr int LRUK_REPLACER_K = 2;              // accesses remembered per frame by the LRU-K replacer
+static constexpr int LRUK_CORRELATED_PERIOD = 8;       // LRU-K accesses this close (in accesses) count as one
+static constexpr int SCAN_RING_SIZE = 32;              // frames a bulk sequential reader recycles
+static constexpr int BGWRITER_CLEAN_FRAMES = 512;      // clean evictable frames the background writer keeps ready
+static constexpr int BGWRITER_MAX_PAGES = 64;          // most pages the background writer writes per round
+static constexpr int BGWRITER_INTERVAL_MS = 20;        // pause between background writer rounds
+static constexpr int BUFFER_POOL_CHUNK_FRAMES = 1024;   // frames the buffer pool allocates and releases together
+static constexpr int READ_AHEAD_PAGES = 8;             // pages table and index iterators prefetch ahead of the scan
+static constexpr int IO_URING_QUEUE_DEPTH = 128;        // submission queue entries of the io_uring backend
+static constexpr int DEFAULT_GROUP_FLUSH_INTERVAL_MS = 200;  // period of the group flush durability mode
+static constexpr int MAX_DEFERRED_WRITES = 8192;             // deferred page writes kept before an early write out
+static constexpr int VACUUM_INTERVAL_MS = 1000;              // pause between background vacuum rounds
+static constexpr int VACUUM_MIN_DELETES = 64;                // deleted rows a table needs before it is vacuumed
+static constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 << 20;   // key bytes an index build sorts before spilling a run
+static constexpr double INDEX_BUILD_FILL_FACTOR = 1.0;       // share of a node an index build fills, 0.5 to 1
+static constexpr int INDEX_BUILD_MAX_THREADS = 16;           // most threads an index build scans and sorts with
+static constexpr int SCAN_BATCH_PAGES = 16;                  // consecutive heap pages a partitioned scan hands out
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
 static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
@@ -23,6 +41,7 @@ static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of var
 
 using page_id_t = int32_t;
 using frame_id_t = int32_t;
+using file_id_t = uint32_t;
 using txn_id_t = int32_t;
 using lsn_t = int32_t;
 using column_id_t = uint32_t;
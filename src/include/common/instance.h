@@ -14,17 +14,40 @@
 
 class DBStorageEngine {
  public:
-  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE);
+  /**
+   * @param shared_pool if set, the database caches its pages in this pool, shared with the other open databases,
+   * instead of a pool of buffer_pool_size frames of its own
+   */
+  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           DurabilityMode durability = DurabilityMode::kWriteThrough,
+                           BufferPoolManager *shared_pool = nullptr);
 
   ~DBStorageEngine();
 
   std::unique_ptr<ExecuteContext> MakeExecuteContext(Transaction *txn);
 
+  /**
+   * Change when page writes reach the db file, see DurabilityMode.
+   */
+  void SetDurabilityMode(DurabilityMode durability);
+
+  /**
+   * Called after every statement, the statement durability mode issues its deferred writes here.
+   */
+  void EndStatement();
+
+  /**
+   * @return the sidecar file the hot page set of db_name is kept in between runs, hidden so it is not taken for a
+   * database
+   */
+  static std::string WarmUpFileName(const std::string &db_name) { return "./databases/." + db_name + ".warmup"; }
+
  public:
   DiskManager *disk_mgr_;
   BufferPoolManager *bpm_;
   CatalogManager *catalog_mgr_;
   std::string db_file_name_;
+  std::string warm_up_file_name_;
   bool init_;
 };
 
@@ -1,8 +1,11 @@
 #ifndef MINISQL_EXECUTE_ENGINE_H
 #define MINISQL_EXECUTE_ENGINE_H
 
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "common/dberr.h"
@@ -22,12 +25,14 @@ extern "C" {
  */
 class ExecuteEngine {
  public:
-  ExecuteEngine();
+  explicit ExecuteEngine(DurabilityMode durability = DurabilityMode::kWriteThrough);
 
   ~ExecuteEngine() {
+    StopVacuumWorker();
     for (auto it : dbs_) {
       delete it.second;
     }
+    delete buffer_pool_;
   }
 
   /**
@@ -40,7 +45,17 @@ class ExecuteEngine {
 
   void ExecuteInformation(dberr_t result);
 
+  /**
+   * Start a thread that vacuums, every interval_ms, the loaded tables of the opened databases once at least
+   * min_deletes of their rows were deleted, see CatalogManager::VacuumLoadedTables. It runs between statements.
+   */
+  void StartVacuumWorker(uint32_t min_deletes = VACUUM_MIN_DELETES, uint32_t interval_ms = VACUUM_INTERVAL_MS);
+
+  void StopVacuumWorker();
+
  private:
+  dberr_t ExecuteStatement(pSyntaxNode ast);
+
   static std::unique_ptr<AbstractExecutor> CreateExecutor(ExecuteContext *exec_ctx, const AbstractPlanNodeRef &plan);
 
   dberr_t ExecuteCreateDatabase(pSyntaxNode ast, ExecuteContext *context);
@@ -59,10 +74,16 @@ class ExecuteEngine {
 
   dberr_t ExecuteShowIndexes(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteShowBufferStatus(pSyntaxNode ast, ExecuteContext *context);
+
+  dberr_t ExecuteSetBufferPool(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteTrxBegin(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteTrxCommit(pSyntaxNode ast, ExecuteContext *context);
@@ -73,9 +94,18 @@ class ExecuteEngine {
 
   dberr_t ExecuteQuit(pSyntaxNode ast, ExecuteContext *context);
 
+  void VacuumWorkerLoop(uint32_t min_deletes, uint32_t interval_ms);
+
  private:
-  std::unordered_map<std::string, DBStorageEngine *> dbs_; /** all opened databases */
+  BufferPoolManager *buffer_pool_;                         /** buffer pool shared by all opened databases */
+  std::unordered_map<std::string, DBStorageEngine *> dbs_; /** all databases, nullptr until the first USE opens one */
   std::string current_db_;                                 /** current database */
+  DurabilityMode durability_;                              /** durability mode of every opened database */
+  std::mutex statement_latch_;                             /** held while a statement or a vacuum round runs */
+  std::thread vacuum_worker_;
+  std::mutex vacuum_latch_;                                /** protects vacuum_stop_ */
+  std::condition_variable vacuum_cv_;
+  bool vacuum_stop_{false};
 };
 
 #endif  // MINISQL_EXECUTE_ENGINE_H
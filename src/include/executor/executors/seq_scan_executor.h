@@ -44,6 +44,8 @@ private:
     bool is_init = false;
     TableHeap *table_heap_;
     TableIterator table_iterator_;
+    /** ring of frames the scan reads through, so a full table scan does not evict the rest of the pool */
+    BufferAccessStrategy scan_strategy_;
     TableInfo *table_info_;
     std::vector<uint32_t> output_attr;
 
@@ -0,0 +1,41 @@
+#ifndef MINISQL_TRUNCATE_EXECUTOR_H
+#define MINISQL_TRUNCATE_EXECUTOR_H
+
+#include "executor/execute_context.h"
+#include "executor/executors/abstract_executor.h"
+#include "executor/plans/truncate_plan.h"
+
+/**
+ * TruncateExecutor empties a table through CatalogManager::TruncateTable. The heap's pages are given back and its
+ * indexes are destroyed page by page, instead of deleting rows and index entries one at a time.
+ */
+class TruncateExecutor : public AbstractExecutor {
+public:
+    /**
+     * Construct a new TruncateExecutor instance.
+     * @param exec_ctx The executor context
+     * @param plan The truncate plan to be executed
+     */
+    TruncateExecutor(ExecuteContext *exec_ctx, const TruncatePlanNode *plan);
+
+    /** Empty the table */
+    void Init() override;
+
+    /**
+     * Yield once for every row the table held, like DeleteExecutor.
+     * @param[out] row not used
+     * @param[out] rid not used
+     * @return `true` while there are removed rows left to count
+     */
+    bool Next(Row *row, RowId *rid) override;
+
+    /** @return The output schema for the truncate */
+    const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
+
+private:
+    /** The truncate plan node to be executed */
+    const TruncatePlanNode *plan_;
+    uint32_t removed_rows_{0};
+};
+
+#endif  // MINISQL_TRUNCATE_EXECUTOR_H
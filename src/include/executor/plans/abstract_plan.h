@@ -18,6 +18,7 @@ enum class PlanType {
   Insert,
   Update,
   Delete,
+  Truncate,
   Values,
   Aggregation,
   Limit,
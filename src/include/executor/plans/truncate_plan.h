@@ -0,0 +1,30 @@
+#ifndef MINISQL_TRUNCATE_PLAN_H
+#define MINISQL_TRUNCATE_PLAN_H
+
+#include "abstract_plan.h"
+#include "catalog/catalog.h"
+
+/**
+ * The TruncatePlanNode removes every row of a table at once. It is planned for TRUNCATE TABLE and for a DELETE
+ * without a WHERE clause, and has no child: no row is read.
+ */
+class TruncatePlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Construct a new TruncatePlanNode.
+   * @param table_name The identifier of the table that is emptied
+   */
+  TruncatePlanNode(const Schema *output, std::string table_name)
+      : AbstractPlanNode(output, {}), table_name_(std::move(table_name)) {}
+
+  /** @return The type of the plan node */
+  PlanType GetType() const override { return PlanType::Truncate; }
+
+  /** @return The identifier of the table that is emptied */
+  std::string GetTableName() const { return table_name_; }
+
+  /** The identifier of the table that is emptied */
+  std::string table_name_;
+};
+
+#endif  // MINISQL_TRUNCATE_PLAN_H
@@ -1,12 +1,15 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <deque>
 #include <queue>
 #include <string>
 #include <vector>
 
 #include "common/config.h"
+#include "common/rwlatch.h"
 #include "index/index_iterator.h"
+#include "index/key_sorter.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
@@ -22,6 +25,14 @@
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ * (5) Lookups, inserts and removes may run concurrently
+ *
+ * Concurrency: readers crab down with read latches, a page is latched before its parent is released. Writers first
+ * descend the same way and write latch only the leaf, most changes fit into the leaf and are done then. A change that
+ * splits or merges the leaf starts over and crabs down with write latches, releasing the ancestors whenever it reaches
+ * a page that is safe, i.e. one the change cannot split or merge. root_latch_ guards root_page_id_: a descent holds it
+ * until the root is latched, a structure change holds it for writing until the root is known to stay the root.
+ * Iterators only pin their leaf, a scan must not run concurrently with changes to the tree.
  */
 class BPlusTree {
     using InternalPage = BPlusTreeInternalPage;
@@ -37,6 +48,14 @@ public:
     // Insert a key-value pair into this B+ tree.
     bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
+    /**
+     * Build the tree bottom up from the finished sorter, the tree must be empty. Leaves are filled left to right with
+     * fill_factor of their max size, then every internal level above them the same way, so each page is written once
+     * and pages of a level are allocated in key order. Of equal keys only the first is kept, as Insert would.
+     * @return false if the tree is not empty
+     */
+    bool BulkLoad(KeySorter &sorter, double fill_factor = INDEX_BUILD_FILL_FACTOR);
+
     // Remove a key and its value from this B+ tree.
     void Remove(const GenericKey *key, Transaction *transaction = nullptr);
 
@@ -49,7 +68,7 @@ public:
 
     IndexIterator End();
 
-    // expose for test purpose
+    // expose for test purpose, the descent takes no latches
     Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
 
     // used to check whether all pages are unpinned
@@ -123,6 +142,7 @@ public:
                     }
                     std::cout << std::endl;
                 }
+                buffer_pool_manager_->UnpinPage(traversed_page_id, false);
             }
             std::cout << std::endl;
             while (page_queue2.size() > 0) {
@@ -166,6 +186,7 @@ public:
                     }
                     std::cout << std::endl;
                 }
+                buffer_pool_manager_->UnpinPage(traversed_page_id, false);
             }
             std::cout << std::endl;
         }
@@ -179,20 +200,119 @@ public:
     }
 
 private:
+    /** What a writer does to the leaf, it decides which pages are safe */
+    enum class Operation { kInsert, kRemove };
+
+    /**
+     * The pages a structure change holds write latched, from the highest ancestor the change may reach down to the
+     * leaf, and whether it holds the root latch. Everything is released when the context goes out of scope.
+     */
+    class Context {
+    public:
+        explicit Context(ReaderWriterLatch *root_latch) : root_latch_(root_latch) {
+            root_latch_->WLock();
+            root_latched_ = true;
+        }
+
+        ~Context() {
+            write_set_.clear();
+            ReleaseRoot();
+        }
+
+        void ReleaseRoot() {
+            if (root_latched_) {
+                root_latch_->WUnlock();
+                root_latched_ = false;
+            }
+        }
+
+        /** Release every page held so far and the root latch, the change cannot reach above the next page */
+        void ReleaseAncestors() {
+            write_set_.clear();
+            ReleaseRoot();
+        }
+
+        /** @return the guard of a held page */
+        WritePageGuard &Get(page_id_t page_id) {
+            for (auto &guard: write_set_) {
+                if (guard.PageId() == page_id) {
+                    return guard;
+                }
+            }
+            ASSERT(false, "A structure change reached a page it does not hold.");
+            return write_set_.back();
+        }
+
+        /** Release a held page early, e.g. before deleting it */
+        void Release(page_id_t page_id) {
+            for (auto it = write_set_.begin(); it != write_set_.end(); ++it) {
+                if (it->PageId() == page_id) {
+                    write_set_.erase(it);
+                    return;
+                }
+            }
+        }
+
+        std::deque<WritePageGuard> write_set_;
+        bool root_latched_{false};
+
+    private:
+        ReaderWriterLatch *root_latch_;
+    };
+
+    /** A level of a tree BulkLoad builds, its shape is fixed before the first entry arrives */
+    struct BulkLoadLevel {
+        int entries_;              // entries of the whole level
+        int nodes_;                // nodes the entries are spread over
+        int node_{0};              // the open node
+        int filled_{0};            // entries in the open node
+        WritePageGuard guard_;     // the open node
+        WritePageGuard previous_;  // the last closed leaf, until the next leaf is linked to it
+
+        /** @return the entries of the open node, the entries are spread evenly */
+        int Share() const {
+            return static_cast<int>(static_cast<int64_t>(entries_) * (node_ + 1) / nodes_ -
+                                    static_cast<int64_t>(entries_) * node_ / nodes_);
+        }
+    };
+
+    /**
+     * Append an entry to the open node of a level, opening a node first if none is, which appends the node to the
+     * level above. Leaves take value, internal nodes child_page_id.
+     * @return the node the entry went to
+     */
+    page_id_t BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, GenericKey *key, const RowId &value,
+                             page_id_t child_page_id);
 
     void StartNewTree(GenericKey *key, const RowId &value);
 
     bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
-    void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
+    void InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Context &context,
                           Transaction *transaction = nullptr);
 
-    LeafPage *Split(LeafPage *node, Transaction *transaction, GenericKey *&middle_key);
+    /** @return whether op on a page below page can leave page itself unchanged in size */
+    bool IsSafe(const BPlusTreePage *page, Operation op) const;
+
+    /** Crab down with read latches, the leaf is returned read latched, or an empty guard if the tree is empty */
+    ReadPageGuard FindLeafPageRead(const GenericKey *key, bool leftMost = false);
+
+    /** Crab down with read latches and write latch the leaf, an empty guard if the tree is empty */
+    WritePageGuard FindLeafPageOptimistic(const GenericKey *key);
+
+    /**
+     * Crab down with write latches, the pages op may change end up in context, the leaf last. Nothing is latched but
+     * the root latch if the tree is empty.
+     */
+    void FindLeafPagePessimistic(const GenericKey *key, Operation op, Context &context);
+
+    /** @return the guarded new right sibling of node */
+    WritePageGuard Split(LeafPage *node, Transaction *transaction, GenericKey *&middle_key);
 
-    InternalPage *Split(InternalPage *node, Transaction *transaction, GenericKey *&middle_key);
+    WritePageGuard Split(InternalPage *node, Transaction *transaction, GenericKey *&middle_key);
 
     template<typename N>
-    bool CoalesceOrRedistribute(N *&node, Transaction *transaction = nullptr);
+    bool CoalesceOrRedistribute(N *&node, Context &context, Transaction *transaction = nullptr);
 
     bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
                   Transaction *transaction = nullptr);
@@ -200,9 +320,9 @@ private:
     bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
                   Transaction *transaction = nullptr);
 
-    void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+    void Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index);
 
-    void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+    void Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index);
 
     bool AdjustRoot(BPlusTreePage *node);
 
@@ -215,6 +335,7 @@ private:
 
 // member variable
     index_id_t index_id_;
+    ReaderWriterLatch root_latch_;  // guards root_page_id_
     page_id_t root_page_id_{INVALID_PAGE_ID};
     BufferPoolManager *buffer_pool_manager_;
     KeyManager processor_;
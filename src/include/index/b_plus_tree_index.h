@@ -7,7 +7,8 @@
 
 class BPlusTreeIndex : public Index {
  public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 KeyEncoding key_encoding = KeyEncoding::kMemcomparable);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
@@ -17,6 +18,13 @@ class BPlusTreeIndex : public Index {
 
   dberr_t Destroy() override;
 
+  /**
+   * Every worker sorts its own entries, spilling to disk past its share of INDEX_BUILD_SORT_MEMORY, the sorted entries
+   * of all workers are merged and the tree is built bottom up from them
+   */
+  dberr_t BulkLoad(size_t num_workers, const std::function<bool(const EntryConsumer &add)> &produce,
+                   Transaction *txn) override;
+
   IndexIterator GetBeginIterator();
 
   IndexIterator GetBeginIterator(GenericKey *key);
@@ -2,6 +2,7 @@
 #define MINISQL_GENERIC_KEY_H
 
 #include <cstring>
+#include <vector>
 
 #include "record/field.h"
 #include "record/row.h"
@@ -12,6 +13,26 @@ class GenericKey {
     char data[0];
 };
 
+/**
+ * How the columns of an index key are laid out in a GenericKey.
+ */
+enum class KeyEncoding {
+    /** the key row serialized with Row::SerializeTo, compared field by field; indexes created before kMemcomparable */
+    kRow,
+    /**
+     * every column as a null marker byte (0 for null, 1 otherwise) followed by an encoding whose bytes sort like the
+     * values: ints big-endian with the sign bit flipped, floats as their bits with the sign bit flipped for positive
+     * and all bits flipped for negative values, chars padded with zeros to the column length and followed by their
+     * length big-endian. Two keys compare with a single memcmp.
+     */
+    kMemcomparable,
+    /**
+     * a single non-null int column stored as the native int32_t, keys take 4 bytes and compare as integers, so pages
+     * hold twice the keys of a 16 byte kMemcomparable key and search them without going through a comparator
+     */
+    kInt32
+};
+
 class KeyManager {
 public: /**/
     [[nodiscard]] inline GenericKey *InitKey() const {
@@ -19,21 +40,85 @@ public: /**/
     }
 
     inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
+        ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
         // initialize to 0
+        memset(key_buf->data, 0, key_size_);
+        if (encoding_ == KeyEncoding::kInt32) {
+            EncodeInt32(key_buf->data, key);
+            return;
+        }
+        if (encoding_ == KeyEncoding::kMemcomparable) {
+            ASSERT(GetMemcomparableSize(schema) <= (uint32_t) key_size_, "Index key size exceed max key size.");
+            EncodeMemcomparable(key_buf->data, key, schema);
+            return;
+        }
         [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
-        ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
         ASSERT(size <= (uint32_t) key_size_, "Index key size exceed max key size.");
-        memset(key_buf->data, 0, key_size_);
         key.SerializeTo(key_buf->data, schema);
     }
 
     inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
+        if (encoding_ == KeyEncoding::kInt32) {
+            DecodeInt32(key_buf->data, key);
+            return;
+        }
+        if (encoding_ == KeyEncoding::kMemcomparable) {
+            DecodeMemcomparable(key_buf->data, key, schema);
+            return;
+        }
         [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
         ASSERT(ofs <= (uint32_t) key_size_, "Index key size exceed max key size.");
     }
 
     // compare
     [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
+        if (encoding_ == KeyEncoding::kInt32) {
+            int32_t lhs_value = GetInt32(lhs);
+            int32_t rhs_value = GetInt32(rhs);
+            return (lhs_value > rhs_value) - (lhs_value < rhs_value);
+        }
+        if (encoding_ == KeyEncoding::kMemcomparable) {
+            return memcmp(lhs->data, rhs->data, compare_size_);
+        }
+        return CompareRowKeys(lhs, rhs);
+    }
+
+    inline int GetKeySize() const { return key_size_; }
+
+    inline KeyEncoding GetEncoding() const { return encoding_; }
+
+    /** @return the bytes a kMemcomparable key of the schema takes */
+    static uint32_t GetMemcomparableSize(const Schema *key_schema);
+
+    /** @return the encoding for a new index on the key_map columns of table_schema */
+    static KeyEncoding ChooseEncoding(const Schema *table_schema, const std::vector<uint32_t> &key_map);
+
+    /** @return the value of a kInt32 key */
+    static inline int32_t GetInt32(const GenericKey *key) {
+        int32_t value;
+        memcpy(&value, key->data, sizeof(value));
+        return value;
+    }
+
+    KeyManager(const KeyManager &other) {
+        this->key_schema_ = other.key_schema_;
+        this->key_size_ = other.key_size_;
+        this->encoding_ = other.encoding_;
+        this->compare_size_ = other.compare_size_;
+    }
+
+    // constructor
+    KeyManager(Schema *key_schema, size_t key_size, KeyEncoding encoding = KeyEncoding::kMemcomparable)
+            : key_size_(key_size), key_schema_(key_schema), encoding_(encoding),
+              compare_size_(encoding == KeyEncoding::kMemcomparable ? GetMemcomparableSize(key_schema) : 0) {}
+
+    Schema *GetSchema() {
+        return key_schema_;
+    }
+
+private:
+    /** field by field comparison of two kRow keys */
+    int CompareRowKeys(const GenericKey *lhs, const GenericKey *rhs) const {
         //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
         uint32_t column_count = key_schema_->GetColumnCount();
         Row lhs_key(INVALID_ROWID);
@@ -46,18 +131,10 @@ public: /**/
             Field *rhs_value = rhs_key.GetField(i);
 
             if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
-//        if (key_schema_->GetColumn(i)->GetType() == kTypeChar) {
-//          delete lhs_value->GetData();
-//          delete rhs_value->GetData();
-//        }
                 return -1;
             }
 
             if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
-//        if (key_schema_->GetColumn(i)->GetType() == kTypeChar) {
-//          delete lhs_value->GetData();
-//          delete rhs_value->GetData();
-//        }
                 return 1;
             }
         }
@@ -65,23 +142,19 @@ public: /**/
         return 0;
     }
 
-    inline int GetKeySize() const { return key_size_; }
+    static void EncodeMemcomparable(char *buf, const Row &key, const Schema *schema);
 
-    KeyManager(const KeyManager &other) {
-        this->key_schema_ = other.key_schema_;
-        this->key_size_ = other.key_size_;
-    }
+    static void DecodeMemcomparable(const char *buf, Row &key, const Schema *schema);
 
-    // constructor
-    KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+    static void EncodeInt32(char *buf, const Row &key);
 
-    Schema *GetSchema() {
-        return key_schema_;
-    }
+    static void DecodeInt32(const char *buf, Row &key);
 
 private:
     int key_size_;
     Schema *key_schema_;
+    KeyEncoding encoding_;
+    uint32_t compare_size_;  // bytes of a kMemcomparable key, the rest of the buffer is always zero
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
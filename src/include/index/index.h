@@ -1,8 +1,11 @@
 #ifndef MINISQL_INDEX_H
 #define MINISQL_INDEX_H
 
+#include <functional>
 #include <memory>
+#include <mutex>
 
+#include "buffer/buffer_pool_stats.h"
 #include "common/dberr.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
@@ -22,9 +25,32 @@ class Index {
 
   virtual dberr_t Destroy() = 0;
 
+  /** Takes one entry of a bulk load, worker tells apart the threads that may call it at the same time */
+  using EntryConsumer = std::function<void(size_t worker, const Row &key, const RowId &row_id)>;
+
+  /**
+   * Fill the empty index with the entries produce passes to its consumer, from up to num_workers threads at once,
+   * each calling it with its own worker number in [0, num_workers). Indexes that can build themselves from all
+   * entries at once override this, the default inserts them one by one. produce returns false if it could not pass
+   * every entry, the load then fails and the index may hold some of the entries.
+   */
+  virtual dberr_t BulkLoad(size_t /*num_workers*/, const std::function<bool(const EntryConsumer &add)> &produce,
+                           Transaction *txn) {
+    std::mutex latch;
+    bool complete = produce([&](size_t, const Row &key, const RowId &row_id) {
+      std::lock_guard<std::mutex> lock(latch);
+      InsertEntry(key, row_id, txn);
+    });
+    return complete ? DB_SUCCESS : DB_FAILED;
+  }
+
+  /** Attribute the buffer pool traffic of this index to counters, see BufferPoolStatsScope */
+  void SetBufferPoolCounters(BufferPoolCounters *counters) { buffer_pool_counters_ = counters; }
+
  protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
+  BufferPoolCounters *buffer_pool_counters_{nullptr};
 };
 
 #endif  // MINISQL_INDEX_H
@@ -1,6 +1,7 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include "buffer/buffer_pool_manager.h"
 #include "page/b_plus_tree_leaf_page.h"
 
 class IndexIterator {
@@ -12,6 +13,10 @@ class IndexIterator {
 
   explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
 
+  IndexIterator(IndexIterator &&other) noexcept = default;
+
+  IndexIterator &operator=(IndexIterator &&other) noexcept = default;
+
   ~IndexIterator();
 
   /** Return the key/value pair this iterator is currently pointing at. */
@@ -26,11 +31,26 @@ class IndexIterator {
   /** Return whether two iterators are not equal. */
   bool operator!=(const IndexIterator &itr) const;
 
+  /** Set how many leaves are prefetched ahead of the current one, 0 turns read-ahead off */
+  void SetReadAhead(size_t pages) { read_ahead_depth = pages; }
+
+  /** Attribute the leaves this iterator reads to counters, see BufferPoolStatsScope */
+  void SetBufferPoolCounters(BufferPoolCounters *counters) { buffer_pool_counters = counters; }
+
  private:
+  /** Prefetch further down the leaf chain until the window is full or its last leaf is still being read */
+  void ReadAhead();
+
+
   page_id_t current_page_id{INVALID_PAGE_ID};
+  BasicPageGuard guard;  // pin on the current leaf, the iterator does not latch it
   LeafPage *page{nullptr};
   int item_index{0};
   BufferPoolManager *buffer_pool_manager{nullptr};
+  page_id_t read_ahead_tail{INVALID_PAGE_ID};  // last leaf that has been prefetched
+  size_t read_ahead_pages{0};                  // prefetched leaves beyond the current one
+  size_t read_ahead_depth{READ_AHEAD_PAGES};
+  BufferPoolCounters *buffer_pool_counters{nullptr};
   // add your own private member variables here
 };
 
@@ -0,0 +1,91 @@
+#ifndef MINISQL_KEY_SORTER_H
+#define MINISQL_KEY_SORTER_H
+
+#include <cstdio>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * Sorts the (key, RowId) entries of an index build by key.
+ *
+ * Entries are serialized into one flat buffer. Once the buffer holds memory_budget bytes it is sorted and written out
+ * as a run to a temporary file, Finish() sorts what is left and Next() then hands out the entries in key order, from
+ * memory if nothing was spilled, else by merging the runs. Every file is read and written sequentially. Entries with
+ * equal keys come out in the order they were added.
+ */
+class KeySorter {
+public:
+    explicit KeySorter(const KeyManager &key_manager, size_t memory_budget = INDEX_BUILD_SORT_MEMORY);
+
+    ~KeySorter();
+
+    DISALLOW_COPY(KeySorter);
+
+    void Add(const Row &key, Schema *key_schema, const RowId &value);
+
+    /** End the input, Add may not be called after */
+    void Finish();
+
+    /**
+     * Hand out the entries of other finished sorters instead of entries of its own, e.g. of the sorters of the threads
+     * of a parallel index build. It replaces Add and Finish, the sources must outlive this sorter. Of equal keys the
+     * one of the earlier source comes first.
+     */
+    void MergeFrom(const std::vector<KeySorter *> &sources);
+
+    /**
+     * The next entry in key order, key stays valid until the next call.
+     * @return false once every entry was returned
+     */
+    bool Next(GenericKey *&key, RowId &value);
+
+    inline size_t GetSize() const { return size_; }
+
+    /** @return the runs merged, spilled to disk or other sorters, 0 if the entries were sorted in memory */
+    inline size_t GetRunCount() const { return runs_.size(); }
+
+private:
+    /** A sorted run, on disk or another sorter, and the entry of it the merge is at */
+    struct Run {
+        FILE *file_;
+        KeySorter *source_;
+        std::vector<char> entry_;
+    };
+
+    inline char *EntryAt(size_t index) { return buffer_.data() + index * entry_size_; }
+
+    inline GenericKey *KeyOf(char *entry) { return reinterpret_cast<GenericKey *>(entry); }
+
+    /** Sort order_ by the keys of the buffered entries */
+    void SortBuffer();
+
+    /** Write the buffered entries out as a sorted run and empty the buffer */
+    void SpillRun();
+
+    /** Read the first entry of every run, Next merges from then on */
+    void StartMerge();
+
+    /** @return false at the end of the run */
+    bool ReadEntry(Run &run);
+
+    /** The merge heap keeps the run with the smallest current key on top */
+    bool RunGreater(size_t lhs, size_t rhs);
+
+    KeyManager key_manager_;
+    size_t entry_size_;   // key followed by its RowId
+    size_t max_entries_;  // entries buffered before a run is spilled
+    std::vector<char> buffer_;
+    size_t buffered_{0};
+    std::vector<uint32_t> order_;  // buffered entries in key order once sorted
+    size_t next_{0};               // next entry of order_ to hand out
+    std::vector<Run> runs_;
+    std::vector<size_t> heap_;  // runs that still have entries
+    bool finished_{false};
+    size_t size_{0};
+};
+
+#endif  // MINISQL_KEY_SORTER_H
@@ -0,0 +1,71 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * One page of a table heap's free space map. It records, for up to MAX_ENTRIES heap pages, how much room each one has
+ * left as a category of CATEGORY_BYTES bytes, rounded down. The pages of one map are chained, see FreeSpaceMap.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | HeapPageId_1 (4) | ... | HeapPageId_n (4) | Category_1 (1) | ... |
+ *  ---------------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  static constexpr uint32_t CATEGORY_BYTES = PAGE_SIZE / 256;
+  static constexpr uint32_t MAX_ENTRIES = (PAGE_SIZE - 8) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetCount() const { return count_; }
+
+  bool IsFull() const { return count_ == MAX_ENTRIES; }
+
+  /**
+   * @return the slot the heap page was added at, the page must not be full
+   */
+  uint32_t Append(page_id_t heap_page_id, uint8_t category);
+
+  page_id_t GetHeapPageId(uint32_t slot) const { return heap_page_ids_[slot]; }
+
+  /** INVALID_PAGE_ID marks a slot whose heap page was removed, it is given to the next heap page added to the map */
+  void SetHeapPageId(uint32_t slot, page_id_t heap_page_id) { heap_page_ids_[slot] = heap_page_id; }
+
+  uint8_t GetCategory(uint32_t slot) const { return categories_[slot]; }
+
+  void SetCategory(uint32_t slot, uint8_t category) { categories_[slot] = category; }
+
+  /**
+   * @return the first slot with at least the given category, GetCount() if there is none
+   */
+  uint32_t FindSlot(uint8_t category) const;
+
+  /** @return the largest category of the page, 0 if it is empty */
+  uint8_t GetMaxCategory() const;
+
+  /** @return the category of a heap page with free_space bytes of room */
+  static uint8_t ToCategory(uint32_t free_space) {
+    return static_cast<uint8_t>(free_space / CATEGORY_BYTES > 255 ? 255 : free_space / CATEGORY_BYTES);
+  }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t heap_page_ids_[MAX_ENTRIES];
+  uint8_t categories_[MAX_ENTRIES];
+};
+
+static_assert(sizeof(FreeSpaceMapPage) <= PAGE_SIZE);
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
@@ -38,17 +38,17 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-//  /** Acquire the page write latch. */
-//  inline void WLatch() { rwlatch_.WLock(); }
-//
-//  /** Release the page write latch. */
-//  inline void WUnlatch() { rwlatch_.WUnlock(); }
-
-//  /** Acquire the page read latch. */
-//  inline void RLatch() { rwlatch_.RLock(); }
-//
-//  /** Release the page read latch. */
-//  inline void RUnlatch() { rwlatch_.RUnlock(); }
+  /** Acquire the page write latch. */
+  inline void WLatch() { rwlatch_.WLock(); }
+
+  /** Release the page write latch. */
+  inline void WUnlatch() { rwlatch_.WUnlock(); }
+
+  /** Acquire the page read latch. */
+  inline void RLatch() { rwlatch_.RLock(); }
+
+  /** Release the page read latch. */
+  inline void RUnlatch() { rwlatch_.RUnlock(); }
 
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
@@ -72,12 +72,14 @@ class Page {
   char data_[PAGE_SIZE]{};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
+  /** The file of the buffer pool this page belongs to, see BufferPoolManager::AttachFile. */
+  file_id_t file_id_ = 0;
   /** The pin count of this page. */
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
   /** Page latch. */
-//  ReaderWriterLatch rwlatch_;
+  ReaderWriterLatch rwlatch_;
 };
 
 #endif  // MINISQL_PAGE_H
@@ -9,14 +9,21 @@
  *                                free space pointer
  *
  *  Header format (size in bytes):
- *  ----------------------------------------------------------------------------
- *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
- *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(2) | DeadSpace (2) |
+ *  ---------------------------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------
+ *  | TupleCount (2) | FreeSlotHead (2) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------------------------------------
+ *
+ *  ApplyDelete does not move any tuple: the deleted tuple's bytes are counted as DeadSpace and its slot goes on the
+ *  free slot list, which is threaded through the offsets of the free slots (slot + 1, 0 ends the list). InsertTuple
+ *  takes slots from that list, and Compact() packs the live tuples together once the dead space is needed.
+ *  The four 2 byte fields share the words of the earlier 4 byte FreeSpacePointer and TupleCount, so pages written
+ *  before read as having no dead space and no free slots.
  **/
 
+#include <cstdint>
 #include <cstring>
 
 #include "common/macros.h"
@@ -54,7 +61,17 @@ class TablePage : public Page {
 
   void ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
-  void ApplyDeleteAll(Transaction *txn, LogManager *log_manager);
+  /**
+   * Apply every delete on the page that is marked but not applied yet, then compact it
+   * @return the number of tuples removed
+   */
+  uint32_t ApplyDeleteAll(Transaction *txn, LogManager *log_manager);
+
+  /**
+   * Move all live tuples to the end of the page in one pass, so the dead space of applied deletes becomes free space
+   * again, and drop free slots from the end of the slot array
+   */
+  void Compact();
 
   void RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
@@ -64,16 +81,75 @@ class TablePage : public Page {
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * @return the serialized size of the largest row InsertTuple can still take, counting the dead space it would
+   * compact away; this is what the free space map records
+   */
+  uint32_t GetMaxInsertSize() {
+    uint32_t free_space = GetFreeSpaceRemaining() + GetDeadSpace();
+    uint32_t slot_size = GetFreeSlotHead() == 0 ? SIZE_TUPLE : 0;
+    return free_space < slot_size ? 0 : free_space - slot_size;
+  }
+
+  /** @return the bytes of applied deletes that Compact() would free */
+  uint32_t GetDeadSpace() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_DEAD_SPACE); }
+
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  /** @return the number of tuples that are neither free slots nor marked deleted, read from the slot array only */
+  uint32_t GetLiveTupleCount() {
+    uint32_t live = 0;
+    for (uint32_t i = 0; i < GetTupleCount(); i++) {
+      if (!IsDeleted(GetTupleSize(i))) {
+        live++;
+      }
+    }
+    return live;
+  }
+
  private:
-  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_FREE_SPACE); }
 
   void SetFreeSpacePointer(uint32_t free_space_pointer) {
-    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+    auto value = static_cast<uint16_t>(free_space_pointer);
+    memcpy(GetData() + OFFSET_FREE_SPACE, &value, sizeof(uint16_t));
   }
 
-  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+  void SetDeadSpace(uint32_t dead_space) {
+    auto value = static_cast<uint16_t>(dead_space);
+    memcpy(GetData() + OFFSET_DEAD_SPACE, &value, sizeof(uint16_t));
+  }
 
-  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+  void SetTupleCount(uint32_t tuple_count) {
+    auto value = static_cast<uint16_t>(tuple_count);
+    memcpy(GetData() + OFFSET_TUPLE_COUNT, &value, sizeof(uint16_t));
+  }
+
+  /** @return the first free slot + 1, 0 if there is none */
+  uint32_t GetFreeSlotHead() { return *reinterpret_cast<uint16_t *>(GetData() + OFFSET_FREE_SLOT_HEAD); }
+
+  void SetFreeSlotHead(uint32_t free_slot_head) {
+    auto value = static_cast<uint16_t>(free_slot_head);
+    memcpy(GetData() + OFFSET_FREE_SLOT_HEAD, &value, sizeof(uint16_t));
+  }
+
+  /** Put an emptied slot on the free slot list */
+  void PushFreeSlot(uint32_t slot_num) {
+    SetTupleSize(slot_num, 0);
+    SetTupleOffsetAtSlot(slot_num, GetFreeSlotHead());
+    SetFreeSlotHead(slot_num + 1);
+  }
+
+  /** @return a slot taken off the free slot list, or a new slot at the end of the slot array */
+  uint32_t PopFreeSlot() {
+    uint32_t head = GetFreeSlotHead();
+    if (head == 0) {
+      SetTupleCount(GetTupleCount() + 1);
+      return GetTupleCount() - 1;
+    }
+    SetFreeSlotHead(GetTupleOffsetAtSlot(head - 1));
+    return head - 1;
+  }
 
   uint32_t GetFreeSpaceRemaining() {
     return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
@@ -103,13 +179,16 @@ class TablePage : public Page {
 
  private:
   static_assert(sizeof(page_id_t) == 4);
+  static_assert(PAGE_SIZE <= UINT16_MAX, "The page header keeps offsets in 2 bytes.");
   static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
   static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
   static constexpr size_t OFFSET_FREE_SPACE = 16;
+  static constexpr size_t OFFSET_DEAD_SPACE = 18;
   static constexpr size_t OFFSET_TUPLE_COUNT = 20;
+  static constexpr size_t OFFSET_FREE_SLOT_HEAD = 22;
   static constexpr size_t OFFSET_TUPLE_OFFSET = 24;
   static constexpr size_t OFFSET_TUPLE_SIZE = 28;
   static constexpr size_t SUCCESS = 0;
@@ -17,6 +17,7 @@
 %token <syntax_node> ON FROM WHERE INTO SET VALUES PRIMARY KEY UNIQUE
 %token <syntax_node> CHAR INT FLOAT AND OR NOT IS FLAGNULL
 %token <syntax_node> IDENTIFIER STRING NUMBER EQ NE LE GE
+%token <syntax_node> BUFFER STATUS POOL VACUUM TRUNCATE
 
 %type <syntax_node> start sql
 %type <syntax_node> sql_create_database sql_drop_database sql_show_databases sql_use_database
@@ -28,6 +29,7 @@
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
 %type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_show_buffer_status sql_set_buffer_pool sql_vacuum sql_truncate_table
 
 %%
 
@@ -58,6 +60,10 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_show_buffer_status { $$ = $1; }
+  | sql_set_buffer_pool { $$ = $1; }
+  | sql_vacuum { $$ = $1; }
+  | sql_truncate_table { $$ = $1; }
   ;
 
 sql_create_database:
@@ -195,6 +201,36 @@ sql_show_indexes:
   }
   ;
 
+sql_show_buffer_status:
+  SHOW BUFFER STATUS {
+    $$ = CreateSyntaxNode(kNodeShowBufferStatus, NULL);
+  }
+  ;
+
+sql_set_buffer_pool:
+  SET BUFFER POOL EQ NUMBER {
+    $$ = CreateSyntaxNode(kNodeSetBufferPool, NULL);
+    SyntaxNodeAddChildren($$, $5);
+  }
+  ;
+
+sql_vacuum:
+  VACUUM IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+    SyntaxNodeAddChildren($$, $2);
+  }
+  | VACUUM {
+    $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+  }
+  ;
+
+sql_truncate_table:
+  TRUNCATE TABLE IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeTruncateTable, NULL);
+    SyntaxNodeAddChildren($$, $3);
+  }
+  ;
+
 sql_select:
   SELECT select_columns FROM IDENTIFIER {
     $$ = CreateSyntaxNode(kNodeSelect, NULL);
@@ -43,7 +43,11 @@ typedef enum {
   kNodeIndexType,            /** type of index */
   kNodeTrxBegin,             /** begin transaction command */
   kNodeTrxCommit,            /** commit transaction command */
-  kNodeTrxRollback           /** rollback transaction command */
+  kNodeTrxRollback,          /** rollback transaction command */
+  kNodeShowBufferStatus,     /** show buffer status command */
+  kNodeSetBufferPool,        /** set buffer pool size command */
+  kNodeVacuum,               /** vacuum command */
+  kNodeTruncateTable         /** truncate table command */
 } SyntaxNodeType;
 
 /**
@@ -11,6 +11,7 @@
 #include "executor/plans/index_scan_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "executor/plans/truncate_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "planner/statement/abstract_statement.h"
@@ -40,6 +41,8 @@ class Planner {
 
   AbstractPlanNodeRef PlanUpdate(std::shared_ptr<UpdateStatement> statement);
 
+  AbstractPlanNodeRef PlanTruncate(std::shared_ptr<DeleteStatement> statement);
+
   /** the root plan node of the plan tree */
   AbstractPlanNodeRef plan_;
 
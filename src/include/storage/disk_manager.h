@@ -2,15 +2,53 @@
 #define DISK_MGR_H
 
 #include <atomic>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/io_uring_engine.h"
+
+/**
+ * How the disk manager talks to the db file.
+ * kPositional: a raw file descriptor accessed with pread/pwrite, no shared cursor, safe for concurrent page I/O.
+ * kStream: the original std::fstream path, every access is serialized by db_io_latch_.
+ * kIoUring: the positional backend plus an io_uring engine for asynchronous batches, falls back to kPositional
+ *           when the kernel does not allow io_uring.
+ */
+enum class DiskIOBackend { kPositional, kStream, kIoUring };
+
+/**
+ * When page writes reach the kernel.
+ * kWriteThrough: every WritePage goes to the file immediately (the original behaviour).
+ * kStatement: writes are kept in memory and issued in page-id order at the end of each statement.
+ * kGroup: writes are kept in memory and a background thread issues them periodically, followed by one fsync.
+ */
+enum class DurabilityMode { kWriteThrough, kStatement, kGroup };
+
+/**
+ * One asynchronous page read or write. Completion is reported through callback_ if set (called on the I/O
+ * completion thread) and then through done_, both get false if the I/O failed. The data buffer must stay valid until
+ * then.
+ */
+struct DiskRequest {
+  bool is_write_{false};
+  page_id_t page_id_{INVALID_PAGE_ID};  // logical page id
+  char *data_{nullptr};
+  std::promise<bool> done_;
+  std::function<void(bool)> callback_;
+};
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
@@ -22,7 +60,7 @@
  */
 class DiskManager {
  public:
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, DiskIOBackend backend = DiskIOBackend::kPositional);
 
   ~DiskManager() {
     if (!closed) {
@@ -30,17 +68,47 @@ class DiskManager {
     }
   }
 
+  /**
+   * Switch the durability mode. Leaving a deferred mode writes out everything that is pending.
+   */
+  void SetDurabilityMode(DurabilityMode mode, uint32_t group_interval_ms = DEFAULT_GROUP_FLUSH_INTERVAL_MS);
+
+  DurabilityMode GetDurabilityMode() const { return durability_mode_; }
+
+  /**
+   * Sync point: issue all deferred writes in page-id order and write back the metadata.
+   * @param sync_to_disk also fsync the file afterwards
+   */
+  void Sync(bool sync_to_disk);
+
   /**
    * Read page from specific page_id
    * Note: page_id = 0 is reserved for free page bit map
+   * @return false on an I/O error
    */
-  void ReadPage(page_id_t logical_page_id, char *page_data);
+  bool ReadPage(page_id_t logical_page_id, char *page_data);
 
   /**
    * Write data to specific page
    * Note: page_id = 0 is reserved for free page bit map
+   * @return false on an I/O error
+   */
+  bool WritePage(page_id_t logical_page_id, const char *page_data);
+
+  /**
+   * Submit a batch of page reads and writes. With the io_uring backend they complete asynchronously, otherwise they
+   * are executed in order through the synchronous path before returning.
+   */
+  void SubmitRequests(std::vector<DiskRequest> &requests);
+
+  std::future<bool> ReadPageAsync(page_id_t logical_page_id, char *page_data);
+
+  std::future<bool> WritePageAsync(page_id_t logical_page_id, const char *page_data);
+
+  /**
+   * Whether SubmitRequests really overlaps I/O, i.e. the io_uring engine is running.
    */
-  void WritePage(page_id_t logical_page_id, const char *page_data);
+  bool IsAsyncIOEnabled() const { return io_engine_ != nullptr; }
 
   /**
    * Get next free page from disk
@@ -58,6 +126,11 @@ class DiskManager {
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Write the dirty extent bitmaps and the meta page back to disk.
+   */
+  void FlushMetadata();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -69,6 +142,8 @@ class DiskManager {
    */
   char *GetMetaData() { return meta_data_; }
 
+  DiskIOBackend GetBackend() const { return backend_; }
+
   static constexpr size_t BITMAP_SIZE = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
 
  private:
@@ -80,26 +155,92 @@ class DiskManager {
   /**
    * Read physical page from disk
    */
-  void ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+  bool ReadPhysicalPage(page_id_t physical_page_id, char *page_data);
+
+  /**
+   * pread/pwrite implementations used by the positional backend, false on an I/O error
+   */
+  bool ReadPhysicalPagePositional(page_id_t physical_page_id, char *page_data);
+
+  bool WritePhysicalPagePositional(page_id_t physical_page_id, const char *page_data);
+
+  /**
+   * Write out the deferred pages in page-id order, caller holds deferred_latch_
+   */
+  void WriteDeferredPages();
+
+  void GroupFlushLoop(uint32_t interval_ms);
+
+  void StopGroupFlush();
+
+  /**
+   * Finish an asynchronous request once the kernel returned, retrying short transfers synchronously
+   */
+  void CompleteRequest(DiskRequest &request, page_id_t physical_page_id, int result);
+
+  /**
+   * fstream implementations used by the stream backend
+   */
+  bool ReadPhysicalPageStream(page_id_t physical_page_id, char *page_data);
+
+  bool WritePhysicalPageStream(page_id_t physical_page_id, const char *page_data);
 
   /**
    * Write data to physical page in disk
    */
-  void WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
+  bool WritePhysicalPage(page_id_t physical_page_id, const char *page_data);
 
   /**
    * Map logical page id to physical page id
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * Physical page id of the bitmap page describing an extent
+   */
+  static page_id_t MapExtentId(uint32_t extent_id) { return 1 + extent_id * (BITMAP_SIZE + 1); }
+
+  /**
+   * Return the cached bitmap page of an extent, reading it from disk on first use.
+   */
+  BitmapPage<PAGE_SIZE> *GetExtentBitmap(uint32_t extent_id);
+
+  /**
+   * Maintain the set of extents that still have free pages.
+   */
+  void AddFreeExtent(uint32_t extent_id);
+
+  void RemoveFreeExtent(uint32_t extent_id);
+
  private:
-  // stream to write db file
+  DiskIOBackend backend_;
+  // file descriptor used by the positional backend
+  int db_fd_{-1};
+  // length of the db file in bytes, maintained in memory so reads need no stat()
+  std::atomic<size_t> file_size_{0};
+  // asynchronous engine of the io_uring backend
+  std::unique_ptr<IoUringEngine> io_engine_;
+  // page writes held back by the statement and group durability modes, keyed by physical page id
+  std::atomic<DurabilityMode> durability_mode_{DurabilityMode::kWriteThrough};
+  std::mutex deferred_latch_;
+  std::map<page_id_t, std::unique_ptr<char[]>> deferred_writes_;
+  std::vector<std::unique_ptr<char[]>> spare_buffers_;
+  std::thread group_flusher_;
+  std::condition_variable group_flush_cv_;
+  bool stop_group_flush_{false};
+  // stream to write db file, used by the stream backend
   std::fstream db_io_;
   std::string file_name_;
   // with multiple buffer pool instances, need to protect file access
   std::recursive_mutex db_io_latch_;
   bool closed{false};
   char meta_data_[PAGE_SIZE];
+  // in-memory copies of the extent bitmap pages, written back lazily by FlushMetadata
+  std::vector<std::unique_ptr<BitmapPage<PAGE_SIZE>>> extent_bitmaps_;
+  std::vector<bool> extent_dirty_;
+  // extents that are not full; free_extent_pos_[e] is the index of e in free_extents_ or -1
+  std::vector<uint32_t> free_extents_;
+  std::vector<int32_t> free_extent_pos_;
 };
 
 #endif
\ No newline at end of file
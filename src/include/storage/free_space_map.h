@@ -0,0 +1,73 @@
+#ifndef MINISQL_FREE_SPACE_MAP_H
+#define MINISQL_FREE_SPACE_MAP_H
+
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/free_space_map_page.h"
+
+/**
+ * FreeSpaceMap tracks how much room every page of a table heap has left, so an insert can go straight to a page that
+ * fits the row instead of only trying the heap's last page. The map is kept in a chain of FreeSpaceMapPages next to
+ * the heap and survives a restart. It is only a hint: a page it offers may turn out to be too full, in which case the
+ * caller corrects the entry with Update and asks again.
+ *
+ * The map pages are read into memory on first use, which is one page per FreeSpaceMapPage::MAX_ENTRIES heap pages.
+ */
+class FreeSpaceMap {
+public:
+    /**
+     * @param first_page_id the first page of an existing map, INVALID_PAGE_ID for a map that is created on first
+     * Update
+     */
+    FreeSpaceMap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id)
+            : buffer_pool_manager_(buffer_pool_manager), first_page_id_(first_page_id) {}
+
+    inline page_id_t GetFirstPageId() const { return first_page_id_; }
+
+    /**
+     * Record that a heap page can take a row of up to free_space bytes, the page is added to the map if it is new
+     */
+    void Update(page_id_t heap_page_id, uint32_t free_space);
+
+    /**
+     * @return a heap page that has room for a row of size bytes according to the map, INVALID_PAGE_ID if there is none
+     */
+    page_id_t FindPage(uint32_t size);
+
+    /**
+     * Forget a heap page that was removed from the heap, its slot is reused by the next page that is added
+     */
+    void Remove(page_id_t heap_page_id);
+
+    /**
+     * Delete the pages of the map, it is empty afterwards
+     */
+    void Free();
+
+private:
+    /** where a heap page is recorded */
+    struct Entry {
+        uint32_t map_index_;
+        uint32_t slot_;
+        uint8_t category_;
+    };
+
+    void Load();
+
+    /** @return the map page to append to, a new one if the last is full, INVALID_PAGE_ID if none can be allocated */
+    page_id_t GetAppendPage();
+
+private:
+    BufferPoolManager *buffer_pool_manager_;
+    page_id_t first_page_id_;
+    bool loaded_{false};
+    std::vector<page_id_t> map_pages_;                // the chain, in order
+    std::vector<uint8_t> max_categories_;             // largest category on each map page
+    std::unordered_map<page_id_t, Entry> entries_;    // every heap page in the map
+    std::vector<Entry> free_slots_;                   // slots of removed heap pages
+    size_t search_start_{0};                          // map page the last search found room on
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_H
@@ -0,0 +1,91 @@
+#ifndef MINISQL_IO_URING_ENGINE_H
+#define MINISQL_IO_URING_ENGINE_H
+
+#include <linux/io_uring.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/macros.h"
+
+/**
+ * A minimal io_uring wrapper built directly on the io_uring_setup/io_uring_enter system calls, so no liburing is
+ * needed. Requests are queued into the submission ring in batches and a reaper thread drains the completion ring,
+ * invoking the completion handler of every request with the kernel result (bytes transferred or -errno).
+ */
+class IoUringEngine {
+ public:
+  using Completion = std::function<void(int result)>;
+
+  struct Request {
+    bool is_write_;
+    int fd_;
+    size_t offset_;
+    char *data_;
+    uint32_t length_;
+    Completion done_;
+  };
+
+  /**
+   * Probe the kernel and set up a ring with the given queue depth.
+   * @return nullptr if io_uring is not available (old kernel, seccomp, ...)
+   */
+  static std::unique_ptr<IoUringEngine> Create(unsigned queue_depth);
+
+  ~IoUringEngine();
+
+  /**
+   * Queue all requests and submit them with as few io_uring_enter calls as possible.
+   * Blocks only while the ring is full.
+   */
+  void Submit(std::vector<Request> &requests);
+
+  /**
+   * Block until every submitted request has completed.
+   */
+  void Drain();
+
+  DISALLOW_COPY_AND_MOVE(IoUringEngine);
+
+ private:
+  IoUringEngine() = default;
+
+  bool Setup(unsigned queue_depth);
+
+  void Enter(unsigned to_submit);
+
+  void ReapLoop();
+
+ private:
+  int ring_fd_{-1};
+  unsigned depth_{0};
+  // submission ring
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  // completion ring, may share the mapping of the submission ring
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+
+  std::mutex submit_latch_;
+  std::condition_variable space_cv_;
+  std::atomic<unsigned> inflight_{0};
+  std::atomic<bool> stop_{false};
+  std::thread reaper_;
+};
+
+#endif  // MINISQL_IO_URING_ENGINE_H
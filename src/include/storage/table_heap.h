@@ -1,10 +1,13 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <functional>
+
 #include "buffer/buffer_pool_manager.h"
 #include "common/config.h"
 #include "page/header_page.h"
 #include "page/table_page.h"
+#include "storage/free_space_map.h"
 #include "storage/table_iterator.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
@@ -20,9 +23,17 @@ public:
         return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
     }
 
+    /**
+     * @param last_page_id the heap's last page when it was last saved, the chain is followed from there in case pages
+     * were added afterwards; INVALID_PAGE_ID to start from the first page
+     * @param free_space_map_page_id first page of the heap's free space map, INVALID_PAGE_ID if it has none yet
+     */
     static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                             LogManager *log_manager, LockManager *lock_manager) {
-        return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+                             LogManager *log_manager, LockManager *lock_manager,
+                             page_id_t last_page_id = INVALID_PAGE_ID,
+                             page_id_t free_space_map_page_id = INVALID_PAGE_ID) {
+        return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager, last_page_id,
+                             free_space_map_page_id);
     }
 
     ~TableHeap() {}
@@ -74,14 +85,50 @@ public:
      */
     bool GetTuple(Row *row, Transaction *txn);
 
+    /**
+     * Physically remove every tuple marked deleted and unlink the pages left empty from the heap, the pages go back
+     * to the buffer pool through DeletePage. The first page is always kept, so the heap's first page id never changes.
+     * Nobody may read or write the heap while it runs.
+     * @param[out] freed_pages number of pages given back, may be nullptr
+     * @return number of tuples removed
+     */
+    uint32_t Vacuum(Transaction *txn, uint32_t *freed_pages = nullptr);
+
+    /**
+     * Remove every tuple of the heap: all pages but the first are given back and the first page is emptied, no tuple
+     * is read. The free space map is rebuilt for the remaining page.
+     * @return number of live tuples the heap held, counted from the slot arrays
+     */
+    uint32_t Truncate(Transaction *txn);
+
+    /**
+     * Read every live tuple with up to num_workers threads and call visit(worker, row) for each, worker is the number
+     * of the thread in [0, num_workers). The calling thread walks the page chain once and hands out batches of up to
+     * SCAN_BATCH_PAGES consecutive pages, already pinned, to whichever worker is free, so the workers read disjoint
+     * ranges of the chain and state kept per worker needs no locking. A small buffer pool gets fewer workers and
+     * smaller batches, the pages pinned at once stay within a quarter of it. Nobody may change the heap meanwhile.
+     * @return false if a page of the chain could not be read, the rows after it were not visited
+     */
+    bool PartitionedScan(size_t num_workers, const std::function<void(size_t worker, Row &row)> &visit);
+
+    /**
+     * @return tuples marked deleted since the heap was opened or last vacuumed, deletes from before it was opened are
+     * not counted
+     */
+    inline uint32_t GetPendingDeletes() const { return pending_deletes_; }
+
     void FreeTableHeap() {
+        BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+        free_space_map_.Free();
+        // walking the whole heap must not flush the rest of the buffer pool
+        BufferAccessStrategy strategy;
         auto next_page_id = first_page_id_;
         while (next_page_id != INVALID_PAGE_ID) {
             auto old_page_id = next_page_id;
-            auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
-            assert(page != nullptr);
-            next_page_id = page->GetNextPageId();
-            buffer_pool_manager_->UnpinPage(old_page_id, false);
+            ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(old_page_id, &strategy);
+            assert(guard.IsValid());
+            next_page_id = guard.As<TablePage>()->GetNextPageId();
+            guard.Drop();
             buffer_pool_manager_->DeletePage(old_page_id);
         }
     }
@@ -92,9 +139,10 @@ public:
     void DeleteTable(page_id_t page_id = INVALID_PAGE_ID);
 
     /**
+     * @param strategy ring the iterator reads pages through, see BufferAccessStrategy; it must outlive the iterator
      * @return the begin iterator of this table
      */
-    TableIterator Begin(Transaction *txn);
+    TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
     /**
      * @return the end iterator of this table
@@ -106,6 +154,21 @@ public:
      */
     inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+    /**
+     * @return the id of the last page of this table as far as it is known, see TableMetadata
+     */
+    inline page_id_t GetLastPageId() const { return last_page_id_; }
+
+    /**
+     * @return the id of the first page of this table's free space map, INVALID_PAGE_ID before it has one
+     */
+    inline page_id_t GetFreeSpaceMapPageId() const { return free_space_map_.GetFirstPageId(); }
+
+    /**
+     * Attribute the buffer pool traffic of this heap and its iterators to counters, see BufferPoolStatsScope
+     */
+    inline void SetBufferPoolCounters(BufferPoolCounters *counters) { buffer_pool_counters_ = counters; }
+
 private:
     /**
      * create table heap and initialize first page
@@ -116,41 +179,48 @@ private:
             : buffer_pool_manager_(buffer_pool_manager),
               schema_(schema),
               log_manager_(log_manager),
-              lock_manager_(lock_manager) {
+              lock_manager_(lock_manager),
+              free_space_map_(buffer_pool_manager, INVALID_PAGE_ID) {
         first_page_id_ = INVALID_PAGE_ID;
-        auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(first_page_id_));
-        ASSERT(page != nullptr, "buffer_pool_manager_->NewPage() failed");
-        page->Init(first_page_id_, INVALID_PAGE_ID, log_manager, txn);
+        WritePageGuard guard = buffer_pool_manager_->NewPageGuarded(first_page_id_);
+        ASSERT(guard.IsValid(), "buffer_pool_manager_->NewPage() failed");
+        guard.AsMut<TablePage>()->Init(first_page_id_, INVALID_PAGE_ID, log_manager, txn);
         last_page_id_ = first_page_id_;
-        buffer_pool_manager_->UnpinPage(first_page_id_, true);
+        last_page_found_ = true;
+        free_space_map_.Update(first_page_id_, guard.AsMut<TablePage>()->GetMaxInsertSize());
     };
 
+    /**
+     * open an existing table heap, no page is read until the first insert, see FindLastPage
+     */
     explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                       LogManager *log_manager, LockManager *lock_manager)
+                       LogManager *log_manager, LockManager *lock_manager, page_id_t last_page_id,
+                       page_id_t free_space_map_page_id)
             : buffer_pool_manager_(buffer_pool_manager),
               first_page_id_(first_page_id),
+              last_page_id_(last_page_id),
               schema_(schema),
               log_manager_(log_manager),
-              lock_manager_(lock_manager) {
-        if (first_page_id_ == INVALID_PAGE_ID) {
-            last_page_id_ = INVALID_PAGE_ID;
-        } else {
-            page_id_t traverse_page_id = first_page_id_;
-            while (auto page = buffer_pool_manager_->FetchPage(traverse_page_id)) {
-                last_page_id_ = traverse_page_id;
-                traverse_page_id = reinterpret_cast<TablePage *>(page)->GetNextPageId();
-                buffer_pool_manager_->UnpinPage(last_page_id_, false);
-            }
-        }
-    }
+              lock_manager_(lock_manager),
+              free_space_map_(buffer_pool_manager, free_space_map_page_id) {}
+
+    /**
+     * follow the page chain from the saved last page, or the first page without one, to the real last page; it stays
+     * invalid for a heap without pages
+     */
+    void FindLastPage();
 
 private:
     BufferPoolManager *buffer_pool_manager_;
     page_id_t first_page_id_;
     page_id_t last_page_id_;
+    bool last_page_found_{false};  // whether last_page_id_ is known to have no next page
     Schema *schema_;
     [[maybe_unused]] LogManager *log_manager_;
     [[maybe_unused]] LockManager *lock_manager_;
+    FreeSpaceMap free_space_map_;
+    uint32_t pending_deletes_{0};
+    BufferPoolCounters *buffer_pool_counters_{nullptr};
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
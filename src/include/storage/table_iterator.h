@@ -14,7 +14,7 @@ public:
     // you may define your own constructor based on your member variables
     TableIterator(const TableHeap &table_heap, const Row &row);
 
-    TableIterator(const TableHeap &table_heap, const RowId &row_id);
+    TableIterator(const TableHeap &table_heap, const RowId &row_id, BufferAccessStrategy *strategy = nullptr);
 
     TableIterator(const TableIterator &other);
 
@@ -40,11 +40,33 @@ public:
 
     TableIterator operator++(int);
 
+    /**
+     * Set how many pages of the page chain are prefetched ahead of the page the iterator is on, 0 turns read-ahead off
+     */
+    void SetReadAhead(size_t pages) { read_ahead_depth_ = pages; }
+
 private:
+    /**
+     * Move to the next tuple, following the page chain past empty pages
+     * @return false if the iterator was on the last tuple, table_page_id_ is INVALID_PAGE_ID then
+     */
+    bool MoveToNextTuple();
+
+    /** The iterator moved one page down the chain, so the read-ahead window shrinks by one page */
+    void StepReadAhead();
+
+    /** Prefetch further down the page chain until the window is full or its last page is still being read */
+    void ReadAhead();
+
+
     // add your own private member variables here
     page_id_t table_page_id_;
     int slot_id_;
     TableHeap *table_heap_;
+    BufferAccessStrategy *strategy_{nullptr};
+    page_id_t read_ahead_tail_{INVALID_PAGE_ID};  // last page of the chain that has been prefetched
+    size_t read_ahead_pages_{0};                  // prefetched pages beyond the current one
+    size_t read_ahead_depth_{READ_AHEAD_PAGES};
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
@@ -1,5 +1,6 @@
 #include "index/b_plus_tree.h"
 
+#include <algorithm>
 #include <string>
 
 #include "common/config.h"
@@ -30,39 +31,38 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
                 (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (KM.GetKeySize() + sizeof(page_id_t)) - 1;
         internal_max_size_ = DEFAULT_INTERNAL_MAX_SIZE;
     }
-    auto index_root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
+    ReadPageGuard index_root_guard = buffer_pool_manager_->FetchPageRead(INDEX_ROOTS_PAGE_ID);
     page_id_t root_page_id;
-    if (index_root_page->GetRootId(index_id_, &root_page_id)) {
+    if (index_root_guard.As<IndexRootsPage>()->GetRootId(index_id_, &root_page_id)) {
         root_page_id_ = root_page_id;
-        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
     }
 }
 
 // destroy
 void BPlusTree::DestroySubTree(page_id_t current_page_id) {
-    auto current_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(current_page_id));
-    if (current_page->IsLeafPage()) {
-        buffer_pool_manager_->DeletePage(current_page_id);
-    } else {
+    ReadPageGuard current_guard = buffer_pool_manager_->FetchPageRead(current_page_id);
+    auto current_page = current_guard.As<BPlusTreePage>();
+    if (!current_page->IsLeafPage()) {
         auto internal_page = reinterpret_cast<BPlusTreeInternalPage *>(current_page);
         for (int i = 0; i < internal_page->GetSize(); i++) {
             DestroySubTree(internal_page->ValueAt(i));
         }
-        buffer_pool_manager_->DeletePage(current_page_id);
     }
+    // a page can only be deleted once nobody holds a pin on it
+    current_guard.Drop();
+    buffer_pool_manager_->DeletePage(current_page_id);
 }
 
 void BPlusTree::Destroy() {
-    auto index_root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
+    root_latch_.WLock();
+    WritePageGuard index_root_guard = buffer_pool_manager_->FetchPageWrite(INDEX_ROOTS_PAGE_ID);
     page_id_t root_page_id;
-    if (index_root_page->GetRootId(index_id_, &root_page_id)) {
-        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
-    } else {
+    if (index_root_guard.As<IndexRootsPage>()->GetRootId(index_id_, &root_page_id)) {
         DestroySubTree(root_page_id);
-        index_root_page->Delete(index_id_);
-        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+        index_root_guard.AsMut<IndexRootsPage>()->Delete(index_id_);
     }
     root_page_id_ = INVALID_PAGE_ID;
+    root_latch_.WUnlock();
 }
 
 
@@ -79,13 +79,12 @@ bool BPlusTree::IsEmpty() const {
  * @return : true means key exists
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction) {
-    if (IsEmpty()) {
+    ReadPageGuard leaf_guard = FindLeafPageRead(key);
+    if (!leaf_guard) {
         return false;
     }
-    auto leaf_page = reinterpret_cast<BPlusTreeLeafPage *>(FindLeafPage(key, false, transaction));
     RowId find_value;
-    auto is_find = leaf_page->Lookup(key, find_value, processor_);
-    if (is_find) {
+    if (leaf_guard.As<LeafPage>()->Lookup(key, find_value, processor_)) {
         result.push_back(find_value);
         return true;
     }
@@ -103,45 +102,48 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Tran
  * keys return false, otherwise return true.
  */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transaction) {
-    if (IsEmpty()) {
-        StartNewTree(key, value);
-        return true;
-    } else {
-        auto leaf_page = reinterpret_cast<BPlusTreeLeafPage *>(FindLeafPage(key, false, transaction));
-        if (leaf_page->GetSize() < leaf_max_size_) {
-            leaf_page->Insert(key, value, processor_);
-            buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-            return true;
-        } else {
-            leaf_page->Insert(key, value, processor_);
-            GenericKey *middle_key = nullptr;
-            auto new_leaf_page = Split(leaf_page, transaction, middle_key);
-            InsertIntoParent(leaf_page, middle_key, new_leaf_page, transaction);
-            buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-            buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(), true);
+    {
+        // most inserts fit into their leaf and only latch it for writing
+        WritePageGuard leaf_guard = FindLeafPageOptimistic(key);
+        if (leaf_guard && IsSafe(leaf_guard.As<LeafPage>(), Operation::kInsert)) {
+            leaf_guard.AsMut<LeafPage>()->Insert(key, value, processor_);
             return true;
         }
     }
+    Context context(&root_latch_);
+    FindLeafPagePessimistic(key, Operation::kInsert, context);
+    if (context.write_set_.empty()) {
+        StartNewTree(key, value);
+        return true;
+    }
+    auto leaf_page = context.write_set_.back().AsMut<LeafPage>();
+    leaf_page->Insert(key, value, processor_);
+    if (leaf_page->GetSize() > leaf_max_size_) {
+        GenericKey *middle_key = nullptr;
+        WritePageGuard new_leaf_guard = Split(leaf_page, transaction, middle_key);
+        InsertIntoParent(leaf_page, middle_key, new_leaf_guard.AsMut<LeafPage>(), context, transaction);
+    }
+    return true;
 }
 
 /*
- * Insert constant key & value pair into an empty tree
+ * Insert constant key & value pair into an empty tree, the caller holds the root latch
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
  */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
-    auto root_page = reinterpret_cast<BPlusTreeLeafPage *>(buffer_pool_manager_->NewPage(root_page_id_));
-    if (root_page == nullptr) {
+    WritePageGuard root_guard = buffer_pool_manager_->NewPageGuarded(root_page_id_);
+    if (!root_guard) {
         LOG(FATAL) << "out of memory";
     }
+    auto root_page = root_guard.AsMut<LeafPage>();
     root_page->Init(root_page_id_, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
     root_page->SetNextPageId(INVALID_PAGE_ID);
-    auto index_root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-    index_root_page->Insert(index_id_, root_page_id_);
-    InsertIntoLeaf(key, value, nullptr);
-    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
-    buffer_pool_manager_->UnpinPage(root_page_id_, true);
+    WritePageGuard index_root_guard = buffer_pool_manager_->FetchPageWrite(INDEX_ROOTS_PAGE_ID);
+    index_root_guard.AsMut<IndexRootsPage>()->Insert(index_id_, root_page_id_);
+    // the new root is the only leaf, looking it up again would latch it twice
+    root_page->Insert(key, value, processor_);
 }
 
 /*
@@ -153,22 +155,24 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
  * keys return false, otherwise return true.
  */
 bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction) {
-    auto leaf_page = reinterpret_cast<BPlusTreeLeafPage *>(FindLeafPage(key, false, transaction));
+    Context context(&root_latch_);
+    FindLeafPagePessimistic(key, Operation::kInsert, context);
+    if (context.write_set_.empty()) {
+        return false;
+    }
+    WritePageGuard &leaf_guard = context.write_set_.back();
+    auto leaf_page = leaf_guard.As<LeafPage>();
     if (leaf_page->KeyFind(key, processor_) != -1) {
         return false;
     }
-    if (leaf_page->GetSize() < leaf_max_size_) {
-        leaf_page->Insert(key, value, processor_);
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-        return true;
-    } else {
+    leaf_guard.MarkDirty();
+    leaf_page->Insert(key, value, processor_);
+    if (leaf_page->GetSize() > leaf_max_size_) {
         GenericKey *middle_key;
-        auto new_leaf_page = Split(leaf_page, transaction, middle_key);
-        InsertIntoParent(leaf_page, middle_key, new_leaf_page, transaction);
-        buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
-        buffer_pool_manager_->UnpinPage(new_leaf_page->GetPageId(), true);
-        return true;
+        WritePageGuard new_leaf_guard = Split(leaf_page, transaction, middle_key);
+        InsertIntoParent(leaf_page, middle_key, new_leaf_guard.AsMut<LeafPage>(), context, transaction);
     }
+    return true;
 }
 
 /*
@@ -178,27 +182,29 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
  */
-BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transaction, GenericKey *&middle_key) {
+WritePageGuard BPlusTree::Split(InternalPage *node, Transaction *transaction, GenericKey *&middle_key) {
     page_id_t new_page_id = INVALID_PAGE_ID;
     // new page is on the right side of node
-    auto new_page = reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager_->NewPage(new_page_id));
-    if (new_page == nullptr) {
+    WritePageGuard new_guard = buffer_pool_manager_->NewPageGuarded(new_page_id);
+    if (!new_guard) {
         LOG(FATAL) << "out of memory";
     }
+    auto new_page = new_guard.AsMut<InternalPage>();
     new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), internal_max_size_);
     middle_key = node->MoveHalfToEmpty(new_page, buffer_pool_manager_);
-    return new_page;
+    return new_guard;
 }
 
-BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction, GenericKey *&middle_key) {
+WritePageGuard BPlusTree::Split(LeafPage *node, Transaction *transaction, GenericKey *&middle_key) {
     page_id_t new_page_id = INVALID_PAGE_ID;
-    auto new_page = reinterpret_cast<BPlusTreeLeafPage *>(buffer_pool_manager_->NewPage(new_page_id));
-    if (new_page == nullptr) {
+    WritePageGuard new_guard = buffer_pool_manager_->NewPageGuarded(new_page_id);
+    if (!new_guard) {
         LOG(FATAL) << "out of memory";
     }
+    auto new_page = new_guard.AsMut<LeafPage>();
     new_page->Init(new_page_id, node->GetParentPageId(), processor_.GetKeySize(), leaf_max_size_);
     middle_key = node->MoveHalfToEmpty(new_page);
-    return new_page;
+    return new_guard;
 }
 
 /*
@@ -209,41 +215,32 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction, Ge
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent is one of the pages held by context, a new root needs the root latch.
  */
-void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
+void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node, Context &context,
                                  Transaction *transaction) {
     // if no parent
     if (old_node->GetParentPageId() == INVALID_PAGE_ID) {
+        ASSERT(context.root_latched_, "Root split without the root latch.");
         page_id_t new_root_page_id = INVALID_PAGE_ID;
-        auto root_page = reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager_->NewPage(new_root_page_id));
-        ASSERT(root_page != nullptr, "out of memory");
+        WritePageGuard root_guard = buffer_pool_manager_->NewPageGuarded(new_root_page_id);
+        ASSERT(root_guard.IsValid(), "out of memory");
+        auto root_page = root_guard.AsMut<InternalPage>();
         root_page->Init(new_root_page_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
         root_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
         old_node->SetParentPageId(new_root_page_id);
         new_node->SetParentPageId(new_root_page_id);
         root_page_id_ = new_root_page_id;
-        auto index_root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-        index_root_page->Update(index_id_, new_root_page_id);
-        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
-        buffer_pool_manager_->UnpinPage(new_root_page_id, true);
+        UpdateRootPageId();
     } else {
-        auto parent_page =
-                reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager_->FetchPage(old_node->GetParentPageId()));
-        if (parent_page->GetSize() < parent_page->GetMaxSize()) {
-            parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
-            buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
-        } else {
-            parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+        auto parent_page = context.Get(old_node->GetParentPageId()).AsMut<InternalPage>();
+        parent_page->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
+        if (parent_page->GetSize() > parent_page->GetMaxSize()) {
             GenericKey *middle_key;
-            auto parent_split_right_page = Split(parent_page, transaction, middle_key);
-//            Row print_row(INVALID_ROWID);
-//            processor_.DeserializeToKey(middle_key, print_row, processor_.GetSchema());
-//            Row print_row2(INVALID_ROWID);
-//            processor_.DeserializeToKey(key, print_row2, processor_.GetSchema());
-            InsertIntoParent(parent_page, middle_key, parent_split_right_page, transaction);
+            WritePageGuard split_guard = Split(parent_page, transaction, middle_key);
+            auto parent_split_right_page = split_guard.AsMut<InternalPage>();
+            InsertIntoParent(parent_page, middle_key, parent_split_right_page, context, transaction);
             parent_split_right_page->SetKeyAt(0, nullptr);
-            buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
-            buffer_pool_manager_->UnpinPage(parent_split_right_page->GetPageId(), true);
         }
     }
 }
@@ -259,18 +256,36 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  * necessary.
  */
 void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) {
-    if (IsEmpty()) {
+    {
+        // most removes leave their leaf at least half full and only latch it for writing
+        WritePageGuard leaf_guard = FindLeafPageOptimistic(key);
+        if (!leaf_guard || leaf_guard.As<LeafPage>()->KeyFind(key, processor_) == -1) {
+            return;
+        }
+        if (IsSafe(leaf_guard.As<LeafPage>(), Operation::kRemove)) {
+            leaf_guard.AsMut<LeafPage>()->RemoveAndDeleteRecord(key, processor_);
+            return;
+        }
+    }
+    Context context(&root_latch_);
+    FindLeafPagePessimistic(key, Operation::kRemove, context);
+    if (context.write_set_.empty()) {
         return;
     }
-    auto leaf_page = reinterpret_cast<BPlusTreeLeafPage *>(FindLeafPage(key, false, transaction));
-    if (leaf_page == nullptr || leaf_page->GetSize() == 0) {
+    auto leaf_page = context.write_set_.back().AsMut<LeafPage>();
+    if (leaf_page->GetSize() == 0) {
         return;
     }
+    page_id_t leaf_page_id = leaf_page->GetPageId();
     leaf_page->RemoveAndDeleteRecord(key, processor_);
+    bool should_delete = false;
     if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
-        CoalesceOrRedistribute(leaf_page, transaction);
+        should_delete = CoalesceOrRedistribute(leaf_page, context, transaction);
+    }
+    context.Release(leaf_page_id);
+    if (should_delete) {
+        buffer_pool_manager_->DeletePage(leaf_page_id);
     }
-    buffer_pool_manager_->UnpinPage(leaf_page->GetPageId(), true);
 }
 
 /* todo
@@ -287,42 +302,51 @@ void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) {
  */
 
 template<typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
+bool BPlusTree::CoalesceOrRedistribute(N *&node, Context &context, Transaction *transaction) {
     if (node->IsRootPage()) {
+        ASSERT(context.root_latched_, "Root change without the root latch.");
         return AdjustRoot(node);
     }
-    auto parent_page =
-            reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager_->FetchPage(node->GetParentPageId()));
+    // the parent is held since node was not safe, the siblings are latched below it
+    page_id_t parent_page_id = node->GetParentPageId();
+    auto parent_page = context.Get(parent_page_id).AsMut<InternalPage>();
     int index = parent_page->ValueIndex(node->GetPageId());
     //index是需要接收结点的结点，所以如果index为0，代表index是最左边的结点，需要从右边的结点接收
     //1. find the recipient of the node
     int recipient_index = index == 0 ? 1 : index - 1;
-    auto recipient_page = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(parent_page->ValueAt(recipient_index)));
+    WritePageGuard recipient_guard = buffer_pool_manager_->FetchPageWrite(parent_page->ValueAt(recipient_index));
+    auto recipient_page = recipient_guard.AsMut<N>();
     //2. if the recipient can not merge with the node, then redistribute
     if (recipient_page->GetSize() + node->GetSize() > node->GetMaxSize()) {
-        Redistribute(recipient_page, node, index);
+        Redistribute(recipient_page, node, parent_page, index);
         return false;
-    } else {
-        //if the be removed node index is zero
-        Coalesce(recipient_page, node, parent_page, index, transaction);
-        if (parent_page->GetSize() < parent_page->GetMinSize()) {
-            CoalesceOrRedistribute(parent_page, transaction);
-        }
-        return true;
     }
+    //if the be removed node index is zero, the right neighbor is merged into node and goes away instead
+    bool node_deleted = Coalesce(recipient_page, node, parent_page, index, transaction);
+    page_id_t recipient_page_id = recipient_guard.PageId();
+    recipient_guard.Drop();
+    if (!node_deleted) {
+        buffer_pool_manager_->DeletePage(recipient_page_id);
+    }
+    bool parent_deleted = false;
+    if (parent_page->GetSize() < parent_page->GetMinSize()) {
+        parent_deleted = CoalesceOrRedistribute(parent_page, context, transaction);
+    }
+    if (parent_deleted) {
+        context.Release(parent_page_id);
+        buffer_pool_manager_->DeletePage(parent_page_id);
+    }
+    return node_deleted;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
- * take info of deletion into account. Remember to deal with coalesce or
- * redistribute recursively if necessary.
+ * Move all the key & value pairs from one page to its sibling page. Parent page must be adjusted to
+ * take info of deletion into account.
  * Using template N to represent either internal page or leaf page.
- * TODO: REPLACE BY YOUR OWN CODE
  * @param   sender_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
- * @return  true means parent node should be deleted, false means no deletion happened
+ * @return  true means node should be deleted, false means the neighbor was merged into node and should be deleted
  **** sender_node is the sender, node is the receiver
  */
 bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
@@ -330,11 +354,11 @@ bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage
     if (index == 0) {
         neighbor_node->MoveAllToLeft(node);
         parent->Remove(index + 1);
-        buffer_pool_manager_->DeletePage(neighbor_node->GetPageId());
+        return false;
     } else {
         node->MoveAllToLeft(neighbor_node);
         parent->Remove(index);
-        buffer_pool_manager_->DeletePage(node->GetPageId());
+        return true;
     }
 }
 
@@ -343,11 +367,11 @@ bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, Inte
     if (index == 0) {
         neighbor_node->MoveAllToLeft(node, parent->KeyAt(index + 1), buffer_pool_manager_);
         parent->Remove(index + 1);
-        buffer_pool_manager_->DeletePage(neighbor_node->GetPageId());
+        return false;
     } else {
         node->MoveAllToLeft(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
         parent->Remove(index);
-        buffer_pool_manager_->DeletePage(node->GetPageId());
+        return true;
     }
 }
 
@@ -360,38 +384,35 @@ bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, Inte
  * Using template N to represent either internal page or leaf page.
  * @param   sender_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of both, latched by the caller
  * the index is the node's index
  */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
+void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index) {
     //if the node's index is zero, then the node is the left one, need some borrow from the right neighbor
-    auto parent_page = reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager_->FetchPage(
-            node->GetParentPageId()));
     if (index == 0) {
-        auto middle_key_index = parent_page->ValueIndex(neighbor_node->GetPageId());
+        auto middle_key_index = parent->ValueIndex(neighbor_node->GetPageId());
         auto new_middle_key = neighbor_node->MoveFirstToEndOf(node);
-        parent_page->SetKeyAt(middle_key_index, new_middle_key);
+        parent->SetKeyAt(middle_key_index, new_middle_key);
     } else {
-        auto middle_key_index = parent_page->ValueIndex(node->GetPageId());
+        auto middle_key_index = parent->ValueIndex(node->GetPageId());
         auto new_middle_key = neighbor_node->MoveLastToFrontOf(node);
-        parent_page->SetKeyAt(middle_key_index, new_middle_key);
+        parent->SetKeyAt(middle_key_index, new_middle_key);
     }
 }
 
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
+void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index) {
     //if the node's index is zero, then the node is the left one, need some borrow from the right neighbor
-    auto parent_page = reinterpret_cast<BPlusTreeInternalPage *>(buffer_pool_manager_->FetchPage(
-            node->GetParentPageId()));
     if (index == 0) {
-        auto middle_key_index = parent_page->ValueIndex(neighbor_node->GetPageId());
-        auto old_middle_key = parent_page->KeyAt(middle_key_index);
+        auto middle_key_index = parent->ValueIndex(neighbor_node->GetPageId());
+        auto old_middle_key = parent->KeyAt(middle_key_index);
         auto new_middle_key = neighbor_node->MoveFirstToEndOf(node, old_middle_key, buffer_pool_manager_);
-        parent_page->SetKeyAt(middle_key_index, new_middle_key);
+        parent->SetKeyAt(middle_key_index, new_middle_key);
         neighbor_node->SetKeyAt(0, nullptr);
     } else {
-        auto middle_key_index = parent_page->ValueIndex(node->GetPageId());
-        auto old_middle_key = parent_page->KeyAt(middle_key_index);
+        auto middle_key_index = parent->ValueIndex(node->GetPageId());
+        auto old_middle_key = parent->KeyAt(middle_key_index);
         auto new_middle_key = neighbor_node->MoveLastToFrontOf(node, old_middle_key, buffer_pool_manager_);
-        parent_page->SetKeyAt(middle_key_index, new_middle_key);
+        parent->SetKeyAt(middle_key_index, new_middle_key);
     }
 }
 
@@ -407,16 +428,16 @@ void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, in
  */
 bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
     if (old_root_node->GetSize() == 0) {
-        auto index_root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-        index_root_page->Delete(index_id_);
-        buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+        WritePageGuard index_root_guard = buffer_pool_manager_->FetchPageWrite(INDEX_ROOTS_PAGE_ID);
+        index_root_guard.AsMut<IndexRootsPage>()->Delete(index_id_);
+        root_page_id_ = INVALID_PAGE_ID;
         return true;
-    } else if (old_root_node->GetSize() == 1) {
+    } else if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+        // the old root is deleted by the caller once it has been unpinned
         root_page_id_ = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
-        auto new_root_page = reinterpret_cast<LeafPage *>(buffer_pool_manager_->FetchPage(root_page_id_));
-        new_root_page->SetParentPageId(INVALID_PAGE_ID);
-        buffer_pool_manager_->DeletePage(old_root_node->GetPageId());
-        buffer_pool_manager_->UnpinPage(root_page_id_, true);
+        // the only child may be the node a caller further up still has latched, so only pin it
+        BasicPageGuard new_root_guard = buffer_pool_manager_->FetchPageBasic(root_page_id_);
+        new_root_guard.AsMut<BPlusTreePage>()->SetParentPageId(INVALID_PAGE_ID);
         UpdateRootPageId();
         return true;
     } else {
@@ -424,6 +445,146 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
     }
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+namespace {
+
+/**
+ * @return the nodes entries are spread over, each holding at most capacity entries and at least min_size unless a
+ * single node takes all of them
+ */
+int PackedNodeCount(int entries, int capacity, int min_size) {
+    int nodes = (entries + capacity - 1) / capacity;
+    // spreading the last node's few entries evenly could leave every node under min_size, use fewer, fuller nodes
+    if (nodes > 1 && entries / nodes < min_size) {
+        nodes = std::max(1, entries / min_size);
+    }
+    return nodes;
+}
+
+}  // namespace
+
+bool BPlusTree::BulkLoad(KeySorter &sorter, double fill_factor) {
+    root_latch_.WLock();
+    if (!IsEmpty()) {
+        root_latch_.WUnlock();
+        return false;
+    }
+    if (sorter.GetSize() == 0) {
+        root_latch_.WUnlock();
+        return true;
+    }
+    fill_factor = std::min(1.0, std::max(0.5, fill_factor));
+    // the shape follows from the number of entries alone: how many nodes every level has, from the leaves up to the
+    // single root. A level is as packed as the fill factor allows and never has a node under its min size
+    std::vector<BulkLoadLevel> levels;
+    int entries = static_cast<int>(sorter.GetSize());
+    while (true) {
+        bool is_leaf = levels.empty();
+        int max_size = is_leaf ? leaf_max_size_ : internal_max_size_;
+        // the min sizes of BPlusTreePage::GetMinSize for a page that is not the root
+        int min_size = is_leaf ? max_size / 2 : (max_size + 1) / 2;
+        int capacity = std::max({1, min_size, static_cast<int>(max_size * fill_factor)});
+        int nodes = PackedNodeCount(entries, capacity, min_size);
+        levels.emplace_back();
+        levels.back().entries_ = entries;
+        levels.back().nodes_ = nodes;
+        if (nodes == 1) {
+            break;
+        }
+        entries = nodes;
+    }
+    GenericKey *key;
+    RowId value;
+    GenericKey *last_key = processor_.InitKey();
+    bool has_last_key = false;
+    while (sorter.Next(key, value)) {
+        // keys are unique, of equal keys the first one added is kept as Insert would
+        if (has_last_key && processor_.CompareKeys(key, last_key) == 0) {
+            continue;
+        }
+        BulkLoadAppend(levels, 0, key, value, INVALID_PAGE_ID);
+        memcpy(reinterpret_cast<void *>(last_key), key, processor_.GetKeySize());
+        has_last_key = true;
+    }
+    free(last_key);
+    for (auto &level: levels) {
+        level.guard_.Drop();
+        level.previous_.Drop();
+    }
+    // a skipped key leaves the last nodes of the levels short of their share, they are just underfull like after a
+    // remove. Only a root left over a single child has to go, as AdjustRoot does it
+    while (true) {
+        WritePageGuard root_guard = buffer_pool_manager_->FetchPageWrite(root_page_id_);
+        auto root_page = root_guard.AsMut<BPlusTreePage>();
+        if (root_page->IsLeafPage() || root_page->GetSize() > 1) {
+            break;
+        }
+        page_id_t child_page_id = reinterpret_cast<InternalPage *>(root_page)->ValueAt(0);
+        root_guard.Drop();
+        buffer_pool_manager_->DeletePage(root_page_id_);
+        root_page_id_ = child_page_id;
+        buffer_pool_manager_->FetchPageWrite(root_page_id_).AsMut<BPlusTreePage>()->SetParentPageId(INVALID_PAGE_ID);
+    }
+    UpdateRootPageId(1);
+    root_latch_.WUnlock();
+    return true;
+}
+
+page_id_t BPlusTree::BulkLoadAppend(std::vector<BulkLoadLevel> &levels, size_t level, GenericKey *key,
+                                    const RowId &value, page_id_t child_page_id) {
+    BulkLoadLevel &current = levels[level];
+    bool is_leaf = level == 0;
+    if (!current.guard_) {
+        page_id_t page_id;
+        WritePageGuard guard = buffer_pool_manager_->NewPageGuarded(page_id);
+        if (!guard) {
+            LOG(FATAL) << "out of memory";
+        }
+        // the first key of a node is its separator in the parent, the root has none
+        page_id_t parent_page_id = INVALID_PAGE_ID;
+        if (level + 1 < levels.size()) {
+            parent_page_id = BulkLoadAppend(levels, level + 1, key, value, page_id);
+        } else {
+            root_page_id_ = page_id;
+        }
+        if (is_leaf) {
+            auto leaf_page = guard.AsMut<LeafPage>();
+            leaf_page->Init(page_id, parent_page_id, processor_.GetKeySize(), leaf_max_size_);
+            leaf_page->SetNextPageId(INVALID_PAGE_ID);
+            if (current.previous_) {
+                current.previous_.AsMut<LeafPage>()->SetNextPageId(page_id);
+                current.previous_.Drop();
+            }
+        } else {
+            guard.AsMut<InternalPage>()->Init(page_id, parent_page_id, processor_.GetKeySize(), internal_max_size_);
+        }
+        current.guard_ = std::move(guard);
+    }
+    page_id_t page_id = current.guard_.PageId();
+    auto page = current.guard_.AsMut<BPlusTreePage>();
+    int index = page->GetSize();
+    page->IncreaseSize(1);
+    if (is_leaf) {
+        auto leaf_page = reinterpret_cast<LeafPage *>(page);
+        leaf_page->SetKeyAt(index, key);
+        leaf_page->SetValueAt(index, value);
+    } else {
+        reinterpret_cast<InternalPage *>(page)->SetPairAt(index, index == 0 ? nullptr : key, child_page_id);
+    }
+    if (++current.filled_ == current.Share()) {
+        current.node_++;
+        current.filled_ = 0;
+        if (is_leaf) {
+            current.previous_ = std::move(current.guard_);
+        } else {
+            current.guard_.Drop();
+        }
+    }
+    return page_id;
+}
+
 /*****************************************************************************
  * INDEX ITERATOR
  *****************************************************************************/
@@ -433,11 +594,12 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-    if (IsEmpty()) {
+    page_id_t leaf_page_id = FindLeafPageRead(nullptr, true).PageId();
+    if (leaf_page_id == INVALID_PAGE_ID) {
         return IndexIterator();
     }
-    auto leftest_leaf_page = FindLeafPage(nullptr, root_page_id_, true);
-    return IndexIterator(leftest_leaf_page->GetPageId(), buffer_pool_manager_, 0);
+    // the iterator takes its own pin on the leaf
+    return IndexIterator(leaf_page_id, buffer_pool_manager_, 0);
 }
 
 /*
@@ -446,18 +608,20 @@ IndexIterator BPlusTree::Begin() {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-    if (IsEmpty()) {
-        return IndexIterator();
-    }
-    auto leaf_page = reinterpret_cast<BPlusTreeLeafPage *> (FindLeafPage(key, root_page_id_, false));
-    if (leaf_page == nullptr) {
-        return IndexIterator();
+    page_id_t leaf_page_id;
+    int index;
+    {
+        ReadPageGuard leaf_guard = FindLeafPageRead(key);
+        if (!leaf_guard) {
+            return IndexIterator();
+        }
+        leaf_page_id = leaf_guard.PageId();
+        index = leaf_guard.As<LeafPage>()->KeyIndex(key, processor_);
     }
-    auto index = leaf_page->KeyIndex(key, processor_);
     if (index == -1) {
         return IndexIterator();
     }
-    return IndexIterator(leaf_page->GetPageId(), buffer_pool_manager_, index);
+    return IndexIterator(leaf_page_id, buffer_pool_manager_, index);
 }
 
 /*
@@ -504,6 +668,75 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
     }
 }
 
+bool BPlusTree::IsSafe(const BPlusTreePage *page, Operation op) const {
+    if (op == Operation::kInsert) {
+        return page->GetSize() < page->GetMaxSize();
+    }
+    return page->GetSize() > page->GetMinSize();
+}
+
+ReadPageGuard BPlusTree::FindLeafPageRead(const GenericKey *key, bool leftMost) {
+    root_latch_.RLock();
+    if (IsEmpty()) {
+        root_latch_.RUnlock();
+        return {};
+    }
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(root_page_id_);
+    root_latch_.RUnlock();
+    while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+        auto internal_page = guard.As<InternalPage>();
+        page_id_t child_page_id = leftMost ? internal_page->ValueAt(0) : internal_page->Lookup(key, processor_);
+        // the child is latched before the parent is released
+        guard = buffer_pool_manager_->FetchPageRead(child_page_id);
+    }
+    return guard;
+}
+
+WritePageGuard BPlusTree::FindLeafPageOptimistic(const GenericKey *key) {
+    root_latch_.RLock();
+    if (IsEmpty()) {
+        root_latch_.RUnlock();
+        return {};
+    }
+    // the type of a page does not change while its parent, or the root latch, is held, so it can be read with a pin
+    BasicPageGuard page_guard = buffer_pool_manager_->FetchPageBasic(root_page_id_);
+    if (page_guard.As<BPlusTreePage>()->IsLeafPage()) {
+        WritePageGuard leaf_guard(std::move(page_guard));
+        root_latch_.RUnlock();
+        return leaf_guard;
+    }
+    ReadPageGuard guard(std::move(page_guard));
+    root_latch_.RUnlock();
+    while (true) {
+        page_id_t child_page_id = guard.As<InternalPage>()->Lookup(key, processor_);
+        BasicPageGuard child_guard = buffer_pool_manager_->FetchPageBasic(child_page_id);
+        if (child_guard.As<BPlusTreePage>()->IsLeafPage()) {
+            return WritePageGuard(std::move(child_guard));
+        }
+        guard = ReadPageGuard(std::move(child_guard));
+    }
+}
+
+void BPlusTree::FindLeafPagePessimistic(const GenericKey *key, Operation op, Context &context) {
+    if (IsEmpty()) {
+        return;
+    }
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(root_page_id_);
+    // a safe root stays the root
+    if (IsSafe(guard.As<BPlusTreePage>(), op)) {
+        context.ReleaseRoot();
+    }
+    context.write_set_.push_back(std::move(guard));
+    while (!context.write_set_.back().As<BPlusTreePage>()->IsLeafPage()) {
+        page_id_t child_page_id = context.write_set_.back().As<InternalPage>()->Lookup(key, processor_);
+        WritePageGuard child_guard = buffer_pool_manager_->FetchPageWrite(child_page_id);
+        if (IsSafe(child_guard.As<BPlusTreePage>(), op)) {
+            context.ReleaseAncestors();
+        }
+        context.write_set_.push_back(std::move(child_guard));
+    }
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -513,13 +746,13 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * updating it.
  */
 void BPlusTree::UpdateRootPageId(int insert_record) {
-    auto index_root_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
+    WritePageGuard index_root_guard = buffer_pool_manager_->FetchPageWrite(INDEX_ROOTS_PAGE_ID);
+    auto index_root_page = index_root_guard.AsMut<IndexRootsPage>();
     if (insert_record != 0) {
         index_root_page->Insert(index_id_, root_page_id_);
     } else {
         index_root_page->Update(index_id_, root_page_id_);
     }
-    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
 /**
@@ -1,16 +1,20 @@
 #include <algorithm>
+#include <memory>
+#include <thread>
 #include "index/b_plus_tree_index.h"
 
 #include "index/generic_key.h"
+#include "index/key_sorter.h"
 #include "utils/tree_file_mgr.h"
 
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, KeyEncoding key_encoding)
         : Index(index_id, key_schema),
-          processor_(key_schema_, key_size),
+          processor_(key_schema_, key_size, key_encoding),
           container_(index_id, buffer_pool_manager, processor_) {}
 //插入entry
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
     GenericKey *index_key = processor_.InitKey();
     processor_.SerializeFromKey(index_key, key, key_schema_);
@@ -28,6 +32,7 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *t
 }
 
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     GenericKey *index_key = processor_.InitKey();
     processor_.SerializeFromKey(index_key, key, key_schema_);
 
@@ -37,6 +42,7 @@ dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *t
 }
 
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     GenericKey *index_key = processor_.InitKey();
     processor_.SerializeFromKey(index_key, key, key_schema_);
     //不同op
@@ -81,16 +87,61 @@ dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transacti
 }
 
 dberr_t BPlusTreeIndex::Destroy() {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     container_.Destroy();
     return DB_SUCCESS;
 }
 
+dberr_t BPlusTreeIndex::BulkLoad(size_t num_workers, const std::function<bool(const EntryConsumer &add)> &produce,
+                                 Transaction * /*txn*/) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    num_workers = std::max<size_t>(1, num_workers);
+    std::vector<std::unique_ptr<KeySorter>> sorters;
+    std::vector<KeySorter *> sources;
+    for (size_t i = 0; i < num_workers; i++) {
+        sorters.emplace_back(new KeySorter(processor_, INDEX_BUILD_SORT_MEMORY / num_workers));
+        sources.push_back(sorters.back().get());
+    }
+    if (!produce([&](size_t worker, const Row &key, const RowId &row_id) {
+            sorters[worker]->Add(key, key_schema_, row_id);
+        })) {
+        // a tree of part of the entries would silently miss rows, leave the index empty
+        return DB_FAILED;
+    }
+    KeySorter merged(processor_);
+    KeySorter *sorted = sources[0];
+    if (num_workers > 1) {
+        // the last in memory sort of every worker runs in parallel as well, only the merge is left to this thread
+        std::vector<std::thread> threads;
+        for (auto sorter: sources) {
+            threads.emplace_back([sorter] { sorter->Finish(); });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        merged.MergeFrom(sources);
+        sorted = &merged;
+    } else {
+        sorted->Finish();
+    }
+    if (!container_.BulkLoad(*sorted)) {
+        return DB_FAILED;
+    }
+    return DB_SUCCESS;
+}
+
 IndexIterator BPlusTreeIndex::GetBeginIterator() {
-    return container_.Begin();
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    IndexIterator iterator = container_.Begin();
+    iterator.SetBufferPoolCounters(buffer_pool_counters_);
+    return iterator;
 }
 
 IndexIterator BPlusTreeIndex::GetBeginIterator(GenericKey *key) {
-    return container_.Begin(key);
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    IndexIterator iterator = container_.Begin(key);
+    iterator.SetBufferPoolCounters(buffer_pool_counters_);
+    return iterator;
 }
 
 IndexIterator BPlusTreeIndex::GetEndIterator() {
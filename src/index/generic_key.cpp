@@ -0,0 +1,142 @@
+#include "index/generic_key.h"
+
+namespace {
+
+constexpr uint32_t SIGN_BIT = 0x80000000u;
+// a char key column ends with its length, so zero bytes at the end of a string still sort after the shorter string
+constexpr uint32_t CHAR_LENGTH_BYTES = 2;
+
+static_assert(PAGE_SIZE <= UINT16_MAX, "a char key length must fit in CHAR_LENGTH_BYTES");
+
+inline void WriteBigEndian(char *buf, uint32_t value, uint32_t bytes) {
+    for (uint32_t i = 0; i < bytes; i++) {
+        buf[i] = static_cast<char>(value >> (8 * (bytes - 1 - i)));
+    }
+}
+
+inline uint32_t ReadBigEndian(const char *buf, uint32_t bytes) {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < bytes; i++) {
+        value = (value << 8) | static_cast<uint8_t>(buf[i]);
+    }
+    return value;
+}
+
+inline uint32_t GetEncodedColumnSize(const Column *column) {
+    if (column->GetType() == TypeId::kTypeChar) {
+        return 1 + column->GetLength() + CHAR_LENGTH_BYTES;
+    }
+    return 1 + column->GetLength();
+}
+
+}  // namespace
+
+uint32_t KeyManager::GetMemcomparableSize(const Schema *key_schema) {
+    uint32_t size = 0;
+    for (auto column: key_schema->GetColumns()) {
+        size += GetEncodedColumnSize(column);
+    }
+    return size;
+}
+
+KeyEncoding KeyManager::ChooseEncoding(const Schema *table_schema, const std::vector<uint32_t> &key_map) {
+    if (key_map.size() == 1) {
+        const Column *column = table_schema->GetColumn(key_map[0]);
+        if (column->GetType() == TypeId::kTypeInt && !column->IsNullable()) {
+            return KeyEncoding::kInt32;
+        }
+    }
+    return KeyEncoding::kMemcomparable;
+}
+
+void KeyManager::EncodeMemcomparable(char *buf, const Row &key, const Schema *schema) {
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+        const Column *column = schema->GetColumn(i);
+        const Field *field = key.GetField(i);
+        uint32_t column_size = GetEncodedColumnSize(column);
+        // null sorts before every value, the rest of its bytes stay zero
+        if (field->IsNull()) {
+            buf += column_size;
+            continue;
+        }
+        buf[0] = 1;
+        switch (column->GetType()) {
+            case TypeId::kTypeInt: {
+                int32_t value;
+                field->SerializeTo(reinterpret_cast<char *>(&value));
+                WriteBigEndian(buf + 1, static_cast<uint32_t>(value) ^ SIGN_BIT, sizeof(uint32_t));
+                break;
+            }
+            case TypeId::kTypeFloat: {
+                float value;
+                field->SerializeTo(reinterpret_cast<char *>(&value));
+                // -0.0 and 0.0 are equal and must encode the same
+                if (value == 0.0f) {
+                    value = 0.0f;
+                }
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                bits = (bits & SIGN_BIT) ? ~bits : bits ^ SIGN_BIT;
+                WriteBigEndian(buf + 1, bits, sizeof(uint32_t));
+                break;
+            }
+            case TypeId::kTypeChar: {
+                uint32_t length = field->GetLength();
+                ASSERT(length <= column->GetLength(), "Char key longer than its column.");
+                memcpy(buf + 1, field->GetData(), length);
+                WriteBigEndian(buf + 1 + column->GetLength(), length, CHAR_LENGTH_BYTES);
+                break;
+            }
+            default:
+                ASSERT(false, "Unsupported key column type.");
+        }
+        buf += column_size;
+    }
+}
+
+void KeyManager::DecodeMemcomparable(const char *buf, Row &key, const Schema *schema) {
+    auto &fields = key.GetFields();
+    for (auto field: fields) {
+        delete field;
+    }
+    fields.clear();
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+        const Column *column = schema->GetColumn(i);
+        TypeId type = column->GetType();
+        if (buf[0] == 0) {
+            fields.push_back(new Field(type));
+        } else if (type == TypeId::kTypeInt) {
+            uint32_t value = ReadBigEndian(buf + 1, sizeof(uint32_t)) ^ SIGN_BIT;
+            fields.push_back(new Field(type, static_cast<int32_t>(value)));
+        } else if (type == TypeId::kTypeFloat) {
+            uint32_t bits = ReadBigEndian(buf + 1, sizeof(uint32_t));
+            bits = (bits & SIGN_BIT) ? bits ^ SIGN_BIT : ~bits;
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            fields.push_back(new Field(type, value));
+        } else {
+            uint32_t length = ReadBigEndian(buf + 1 + column->GetLength(), CHAR_LENGTH_BYTES);
+            fields.push_back(new Field(type, const_cast<char *>(buf + 1), length, true));
+        }
+        buf += GetEncodedColumnSize(column);
+    }
+}
+
+void KeyManager::EncodeInt32(char *buf, const Row &key) {
+    const Field *field = key.GetField(0);
+    ASSERT(!field->IsNull(), "Null in a kInt32 key.");
+    int32_t value;
+    field->SerializeTo(reinterpret_cast<char *>(&value));
+    memcpy(buf, &value, sizeof(value));
+}
+
+void KeyManager::DecodeInt32(const char *buf, Row &key) {
+    auto &fields = key.GetFields();
+    for (auto field: fields) {
+        delete field;
+    }
+    fields.clear();
+    int32_t value;
+    memcpy(&value, buf, sizeof(value));
+    fields.push_back(new Field(TypeId::kTypeInt, value));
+}
@@ -7,30 +7,34 @@ IndexIterator::IndexIterator() : current_page_id(INVALID_PAGE_ID), item_index(-1
 
 IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
         : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
-    page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id));
+    guard = buffer_pool_manager->FetchPageBasic(current_page_id);
+    page = guard.As<LeafPage>();
 }
 
-IndexIterator::~IndexIterator() {
-    if (current_page_id != INVALID_PAGE_ID) buffer_pool_manager->UnpinPage(current_page_id, false);
-}
+IndexIterator::~IndexIterator() = default;
 
 std::pair<GenericKey *, RowId> IndexIterator::operator*() { return page->GetItem(item_index); }
 
 IndexIterator &IndexIterator::operator++() {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters);
     if (item_index < page->GetSize() - 1) {
         item_index++;
     } else {
         page_id_t next_page_id = page->GetNextPageId();
+        guard.Drop();
         if (next_page_id == INVALID_PAGE_ID) {
             current_page_id = INVALID_PAGE_ID;
             item_index = -1;
-            buffer_pool_manager->UnpinPage(page->GetPageId(), false);
             page = nullptr;
         } else {
-            buffer_pool_manager->UnpinPage(page->GetPageId(), false);
-            page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(next_page_id));
+            guard = buffer_pool_manager->FetchPageBasic(next_page_id);
+            page = guard.As<LeafPage>();
             current_page_id = next_page_id;
             item_index = 0;
+            if (read_ahead_pages > 0) {
+                read_ahead_pages--;
+            }
+            ReadAhead();
         }
     }
     return *this;
@@ -40,4 +44,27 @@ bool IndexIterator::operator==(const IndexIterator &itr) const {
     return current_page_id == itr.current_page_id && item_index == itr.item_index;
 }
 
-bool IndexIterator::operator!=(const IndexIterator &itr) const { return !(*this == itr); }
\ No newline at end of file
+bool IndexIterator::operator!=(const IndexIterator &itr) const { return !(*this == itr); }
+
+void IndexIterator::ReadAhead() {
+    if (read_ahead_depth == 0) {
+        return;
+    }
+    if (read_ahead_pages == 0) {
+        read_ahead_tail = current_page_id;
+    }
+    while (read_ahead_pages < read_ahead_depth && read_ahead_tail != INVALID_PAGE_ID &&
+           !buffer_pool_manager->IsPageLoading(read_ahead_tail)) {
+        BasicPageGuard tail_guard = buffer_pool_manager->FetchPageBasic(read_ahead_tail);
+        if (!tail_guard) {
+            return;
+        }
+        page_id_t next_page_id = tail_guard.As<LeafPage>()->GetNextPageId();
+        tail_guard.Drop();
+        read_ahead_tail = next_page_id;
+        if (next_page_id != INVALID_PAGE_ID) {
+            buffer_pool_manager->PrefetchPage(next_page_id);
+            read_ahead_pages++;
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#include "index/key_sorter.h"
+
+#include <algorithm>
+
+#include "glog/logging.h"
+
+namespace {
+
+// stdio buffer of a run file, runs are only read and written front to back
+constexpr size_t RUN_IO_BUFFER_SIZE = 1 << 20;
+
+}  // namespace
+
+KeySorter::KeySorter(const KeyManager &key_manager, size_t memory_budget)
+        : key_manager_(key_manager), entry_size_(key_manager.GetKeySize() + sizeof(RowId)) {
+    // the order_ slot of an entry counts against the budget as well
+    max_entries_ = std::max<size_t>(1, memory_budget / (entry_size_ + sizeof(uint32_t)));
+}
+
+KeySorter::~KeySorter() {
+    for (auto &run: runs_) {
+        if (run.file_ != nullptr) {
+            fclose(run.file_);
+        }
+    }
+}
+
+void KeySorter::Add(const Row &key, Schema *key_schema, const RowId &value) {
+    ASSERT(!finished_, "Add after Finish.");
+    if (buffered_ == max_entries_) {
+        SpillRun();
+    }
+    // grow with the input, a small table does not pay for the whole budget
+    if ((buffered_ + 1) * entry_size_ > buffer_.size()) {
+        buffer_.resize(std::min(std::max<size_t>(buffer_.size() * 2, entry_size_ * 64), max_entries_ * entry_size_));
+    }
+    char *entry = EntryAt(buffered_++);
+    key_manager_.SerializeFromKey(KeyOf(entry), key, key_schema);
+    memcpy(entry + key_manager_.GetKeySize(), &value, sizeof(RowId));
+    size_++;
+}
+
+void KeySorter::Finish() {
+    ASSERT(!finished_, "Finish called twice.");
+    finished_ = true;
+    if (runs_.empty()) {
+        SortBuffer();
+        return;
+    }
+    // merge the rest from disk too, the merge only has to look at runs
+    if (buffered_ > 0) {
+        SpillRun();
+    }
+    buffer_ = std::vector<char>();
+    order_ = std::vector<uint32_t>();
+    for (auto &run: runs_) {
+        rewind(run.file_);
+    }
+    StartMerge();
+}
+
+void KeySorter::MergeFrom(const std::vector<KeySorter *> &sources) {
+    ASSERT(!finished_ && size_ == 0, "MergeFrom on a sorter that has entries of its own.");
+    finished_ = true;
+    for (auto source: sources) {
+        ASSERT(source->finished_, "MergeFrom an unfinished sorter.");
+        ASSERT(source->entry_size_ == entry_size_, "MergeFrom a sorter of other keys.");
+        runs_.push_back({nullptr, source, {}});
+        size_ += source->GetSize();
+    }
+    StartMerge();
+}
+
+void KeySorter::StartMerge() {
+    for (size_t i = 0; i < runs_.size(); i++) {
+        runs_[i].entry_.resize(entry_size_);
+        if (ReadEntry(runs_[i])) {
+            heap_.push_back(i);
+        }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), [this](size_t lhs, size_t rhs) { return RunGreater(lhs, rhs); });
+}
+
+bool KeySorter::Next(GenericKey *&key, RowId &value) {
+    ASSERT(finished_, "Next before Finish.");
+    char *entry;
+    if (runs_.empty()) {
+        if (next_ == buffered_) {
+            return false;
+        }
+        entry = EntryAt(order_[next_++]);
+    } else {
+        if (heap_.empty()) {
+            return false;
+        }
+        auto greater = [this](size_t lhs, size_t rhs) { return RunGreater(lhs, rhs); };
+        // the run on top is taken out of the heap, its entry is handed out and then replaced by the next one
+        std::pop_heap(heap_.begin(), heap_.end(), greater);
+        Run &run = runs_[heap_.back()];
+        buffer_.assign(run.entry_.begin(), run.entry_.end());
+        if (ReadEntry(run)) {
+            std::push_heap(heap_.begin(), heap_.end(), greater);
+        } else {
+            heap_.pop_back();
+        }
+        entry = buffer_.data();
+    }
+    key = KeyOf(entry);
+    memcpy(&value, entry + key_manager_.GetKeySize(), sizeof(RowId));
+    return true;
+}
+
+void KeySorter::SortBuffer() {
+    order_.resize(buffered_);
+    for (size_t i = 0; i < buffered_; i++) {
+        order_[i] = static_cast<uint32_t>(i);
+    }
+    // equal keys keep the order they were added in
+    std::sort(order_.begin(), order_.end(), [this](uint32_t lhs, uint32_t rhs) {
+        int compare = key_manager_.CompareKeys(KeyOf(EntryAt(lhs)), KeyOf(EntryAt(rhs)));
+        return compare < 0 || (compare == 0 && lhs < rhs);
+    });
+    next_ = 0;
+}
+
+void KeySorter::SpillRun() {
+    SortBuffer();
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+        LOG(FATAL) << "failed to create a run file for an index build";
+    }
+    setvbuf(file, nullptr, _IOFBF, RUN_IO_BUFFER_SIZE);
+    for (auto index: order_) {
+        if (fwrite(EntryAt(index), entry_size_, 1, file) != 1) {
+            LOG(FATAL) << "failed to write a run of an index build";
+        }
+    }
+    runs_.push_back({file, nullptr, {}});
+    buffered_ = 0;
+}
+
+bool KeySorter::ReadEntry(Run &run) {
+    if (run.file_ != nullptr) {
+        return fread(run.entry_.data(), entry_size_, 1, run.file_) == 1;
+    }
+    GenericKey *key;
+    RowId value;
+    if (!run.source_->Next(key, value)) {
+        return false;
+    }
+    memcpy(run.entry_.data(), key, key_manager_.GetKeySize());
+    memcpy(run.entry_.data() + key_manager_.GetKeySize(), &value, sizeof(RowId));
+    return true;
+}
+
+bool KeySorter::RunGreater(size_t lhs, size_t rhs) {
+    // runs were spilled, or sources given, in the order their entries were added, an earlier run wins a tie
+    int compare = key_manager_.CompareKeys(KeyOf(runs_[lhs].entry_.data()), KeyOf(runs_[rhs].entry_.data()));
+    return compare > 0 || (compare == 0 && lhs > rhs);
+}
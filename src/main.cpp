@@ -31,13 +31,26 @@ void InputCommand(char *input, const int len) {
   getchar();      // remove enter
 }
 
+DurabilityMode ParseDurabilityMode(int argc, char **argv) {
+  // usage: main [--durability=write-through|statement|group]
+  const char *prefix = "--durability=";
+  for (int i = 1; i < argc; i++) {
+    if (strncmp(argv[i], prefix, strlen(prefix)) != 0) continue;
+    const char *mode = argv[i] + strlen(prefix);
+    if (strcmp(mode, "statement") == 0) return DurabilityMode::kStatement;
+    if (strcmp(mode, "group") == 0) return DurabilityMode::kGroup;
+    if (strcmp(mode, "write-through") != 0) LOG(WARNING) << "Unknown durability mode " << mode << std::endl;
+  }
+  return DurabilityMode::kWriteThrough;
+}
+
 int main(int argc, char **argv) {
   InitGoogleLog(argv[0]);
   // command buffer
   const int buf_size = 1024;
   char cmd[buf_size];
   // executor engine
-  ExecuteEngine engine;
+  ExecuteEngine engine(ParseDurabilityMode(argc, argv));
   // for print syntax tree
   TreeFileManagers syntax_tree_file_mgr("syntax_tree_");
   uint32_t syntax_tree_id = 0;
@@ -84,6 +84,11 @@ void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
  * 用了二分查找
  */
 page_id_t InternalPage::Lookup(const GenericKey *key, const KeyManager &KM) {
+    if (KM.GetEncoding() == KeyEncoding::kInt32) {
+        // the last of the keys from the second one on that is not greater than key, the first child if there is none
+        return ValueAt(UpperBound<int32_t>(pairs_off + pair_size + key_off, pair_size, GetSize() - 1,
+                                           KeyManager::GetInt32(key)));
+    }
     //牺牲一个指针，从1开始，right还得-1防止溢出
     int left = 1, right = GetSize() - 1;
     int found = 0;
@@ -167,10 +172,10 @@ void InternalPage::CopyNFrom(void *src, int size, BufferPoolManager *buffer_pool
     PairCopy(PairPtrAt(old_size), src, size);
     for (int i = old_size; i < GetSize(); ++i) {
         page_id_t child_page_id = ValueAt(i);
-        auto child_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(child_page_id));
-        ASSERT(child_page != nullptr, "fetch child page failed");
-        child_page->SetParentPageId(GetPageId());
-        buffer_pool_manager->UnpinPage(child_page_id, true);
+        // the child may be latched by the caller, adopting it only needs a pin
+        BasicPageGuard child_guard = buffer_pool_manager->FetchPageBasic(child_page_id);
+        ASSERT(child_guard.IsValid(), "fetch child page failed");
+        child_guard.AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
     }
 }
 
@@ -251,10 +256,10 @@ void InternalPage::PushBack(GenericKey *key, const page_id_t value, BufferPoolMa
     SetKeyAt(old_size, key);
     SetValueAt(old_size, value);
     page_id_t child_page_id = value;
-    auto child_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(child_page_id));
-    ASSERT(child_page != nullptr, "fetch child page failed");
-    child_page->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(child_page_id, true);
+    // the child may be latched by the caller, adopting it only needs a pin
+    BasicPageGuard child_guard = buffer_pool_manager->FetchPageBasic(child_page_id);
+    ASSERT(child_guard.IsValid(), "fetch child page failed");
+    child_guard.AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
 }
 
 /*
@@ -285,8 +290,8 @@ void InternalPage::PushFront(const page_id_t value, BufferPoolManager *buffer_po
     PairCopy(PairPtrAt(1), PairPtrAt(0), old_size);
     SetPairAt(0, nullptr, value);
     page_id_t child_page_id = value;
-    auto child_page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager->FetchPage(child_page_id));
-    ASSERT(child_page != nullptr, "fetch child page failed");
-    child_page->SetParentPageId(GetPageId());
-    buffer_pool_manager->UnpinPage(child_page_id, true);
+    // the child may be latched by the caller, adopting it only needs a pin
+    BasicPageGuard child_guard = buffer_pool_manager->FetchPageBasic(child_page_id);
+    ASSERT(child_guard.IsValid(), "fetch child page failed");
+    child_guard.AsMut<BPlusTreePage>()->SetParentPageId(GetPageId());
 }
\ No newline at end of file
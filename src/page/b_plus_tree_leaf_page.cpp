@@ -52,6 +52,10 @@ void LeafPage::SetNextPageId(page_id_t next_page_id) {
  * note: if not found return -1
  */
 int LeafPage::KeyIndex(const GenericKey *key, const KeyManager &KM) {
+    if (KM.GetEncoding() == KeyEncoding::kInt32) {
+        int index = LowerBound<int32_t>(pairs_off + key_off, pair_size, GetSize(), KeyManager::GetInt32(key));
+        return index == GetSize() ? -1 : index;
+    }
     // right-1，是偏移量
     int left = 0, right = GetSize() - 1;
     int found = -1;
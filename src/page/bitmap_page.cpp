@@ -7,18 +7,22 @@
  */
 template <size_t PageSize>
 bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
-  for (int i = 0; i < MAX_CHARS; i++) {
+  // next_free_page_ is a lower bound of the first free page, so full bytes before it are never rescanned
+  for (size_t i = next_free_page_ / 8; i < MAX_CHARS; i++) {
+    if (bytes[i] == 0xff) continue;
     unsigned char test = 1;
     for (int j = 0; j < 8; j++) {
       if ((bytes[i] & test) == 0) {
         bytes[i] += test;
         page_offset = i * 8 + j;
         page_allocated_++;
+        next_free_page_ = page_offset + 1;
         return true;
       } else
         test *= 2;
     }
   }
+  next_free_page_ = MAX_CHARS * 8;
   return false;
 }
 
@@ -35,6 +39,7 @@ bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
   if ((bit_cmp & bytes[tem1]) > 0) {
     bytes[tem1] -= bit_cmp;
     page_allocated_--;
+    if (page_offset < next_free_page_) next_free_page_ = page_offset;
     return true;
   } else
     return false;
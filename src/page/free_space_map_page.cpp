@@ -0,0 +1,29 @@
+#include "page/free_space_map_page.h"
+
+#include "common/macros.h"
+
+uint32_t FreeSpaceMapPage::Append(page_id_t heap_page_id, uint8_t category) {
+  ASSERT(!IsFull(), "Free space map page is full.");
+  heap_page_ids_[count_] = heap_page_id;
+  categories_[count_] = category;
+  return count_++;
+}
+
+uint32_t FreeSpaceMapPage::FindSlot(uint8_t category) const {
+  for (uint32_t i = 0; i < count_; i++) {
+    if (categories_[i] >= category) {
+      return i;
+    }
+  }
+  return count_;
+}
+
+uint8_t FreeSpaceMapPage::GetMaxCategory() const {
+  uint8_t max_category = 0;
+  for (uint32_t i = 0; i < count_; i++) {
+    if (categories_[i] > max_category) {
+      max_category = categories_[i];
+    }
+  }
+  return max_category;
+}
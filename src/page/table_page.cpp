@@ -1,25 +1,36 @@
 #include "page/table_page.h"
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn) {
   memcpy(GetData(), &page_id, sizeof(page_id));
   SetPrevPageId(prev_id);
   SetNextPageId(INVALID_PAGE_ID);
   SetFreeSpacePointer(PAGE_SIZE);
+  SetDeadSpace(0);
   SetTupleCount(0);
+  SetFreeSlotHead(0);
 }
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) {
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
-  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-    return false;
-  }
-  // not try to find a free slot to reuse.
-  uint32_t i = GetTupleCount();
-  if (i == GetTupleCount() && GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
-    return false;
+  // a free slot is reused, otherwise the slot array grows by one
+  uint32_t needed = serialized_size + (GetFreeSlotHead() == 0 ? SIZE_TUPLE : 0);
+  if (GetFreeSpaceRemaining() < needed) {
+    if (GetFreeSpaceRemaining() + GetDeadSpace() < needed) {
+      return false;
+    }
+    Compact();
+    needed = serialized_size + (GetFreeSlotHead() == 0 ? SIZE_TUPLE : 0);
+    if (GetFreeSpaceRemaining() < needed) {
+      return false;
+    }
   }
+  uint32_t i = PopFreeSlot();
   // Otherwise we claim available free space..
   SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
   row.SetRowId(RowId(this->GetTablePageId(), i));
@@ -31,9 +42,6 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn, LockMana
   SetTupleSize(i, serialized_size);
   // Set rid
   row.SetRowId(RowId(GetTablePageId(), i));
-  if (i == GetTupleCount()) {
-    SetTupleCount(GetTupleCount() + 1);
-  }
   return true;
 }
 
@@ -74,7 +82,10 @@ uint8_t TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
   // TODO: we do the update by moving all the tuples after the updated tuple to the end of the page,
   //    it is not efficient. if there is a bottleneck in update, we can optimize it.
   if (GetFreeSpaceRemaining() + tuple_size < serialized_size) {
-    return OUT_OF_MEMORY;
+    if (GetFreeSpaceRemaining() + GetDeadSpace() + tuple_size < serialized_size) {
+      return OUT_OF_MEMORY;
+    }
+    Compact();
   }
   // Copy out the old value.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
@@ -110,26 +121,68 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
   if (IsDeleted(tuple_size)) {
     tuple_size = UnsetDeletedFlag(tuple_size);
   }
+  if (tuple_size == 0) {
+    return;
+  }
+  ASSERT(tuple_offset >= GetFreeSpacePointer(), "Free space appears before tuples.");
+  // nothing is moved here: the bytes become dead space for the next Compact(), unless they border the free space
+  if (tuple_offset == GetFreeSpacePointer()) {
+    SetFreeSpacePointer(tuple_offset + tuple_size);
+  } else {
+    SetDeadSpace(GetDeadSpace() + tuple_size);
+  }
+  PushFreeSlot(slot_num);
+}
 
-  uint32_t free_space_pointer = GetFreeSpacePointer();
-  ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
-
-  memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
-          tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size);
-  SetTupleSize(slot_num, 0);
-//  SetTupleCount(GetTupleCount() - 1);
-  SetTupleOffsetAtSlot(slot_num, 0);
+uint32_t TablePage::ApplyDeleteAll(Transaction *txn, LogManager *log_manager) {
+  uint32_t removed = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size != 0 && IsDeleted(tuple_size)) {
+      SetDeadSpace(GetDeadSpace() + UnsetDeletedFlag(tuple_size));
+      PushFreeSlot(i);
+      removed++;
+    }
+  }
+  if (removed > 0) {
+    Compact();
+  }
+  return removed;
+}
 
-  // Update all tuple offsets.
-  for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
-    if (GetTupleSize(i) != 0 && tuple_offset_i < tuple_offset) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size);
+void TablePage::Compact() {
+  // live tuples, including deletes not applied yet, from the end of the page down
+  std::vector<std::pair<uint32_t, uint32_t>> tuples;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    if (GetTupleSize(i) != 0) {
+      tuples.emplace_back(GetTupleOffsetAtSlot(i), i);
+    }
+  }
+  std::sort(tuples.begin(), tuples.end(), std::greater<>());
+  uint32_t free_space_pointer = PAGE_SIZE;
+  for (auto &tuple : tuples) {
+    uint32_t tuple_size = UnsetDeletedFlag(GetTupleSize(tuple.second));
+    free_space_pointer -= tuple_size;
+    if (tuple.first != free_space_pointer) {
+      memmove(GetData() + free_space_pointer, GetData() + tuple.first, tuple_size);
+      SetTupleOffsetAtSlot(tuple.second, free_space_pointer);
+    }
+  }
+  SetFreeSpacePointer(free_space_pointer);
+  SetDeadSpace(0);
+  // give back free slots at the end of the slot array, and rebuild the list lowest slot first
+  uint32_t tuple_count = GetTupleCount();
+  while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+    tuple_count--;
+  }
+  SetTupleCount(tuple_count);
+  SetFreeSlotHead(0);
+  for (uint32_t i = tuple_count; i > 0; i--) {
+    if (GetTupleSize(i - 1) == 0) {
+      PushFreeSlot(i - 1);
     }
   }
 }
-void TablePage::ApplyDeleteAll(Transaction *txn, LogManager *log_manager) {}
 
 void TablePage::RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
@@ -577,10 +577,31 @@ char *yytext;
 #line 1 "minisql.l"
 #line 2 "minisql.l"
     #include <stdio.h>
+    #include <string.h>
     #include "parser/parser.h"
     #include "parser/minisql_yacc.h"
     int yywrap();
     extern YYSTYPE yylval;
+
+    /* keywords that are matched by the identifier rule rather than by a rule of their own */
+    static int MinisqlExtraKeyword(const char *text) {
+      static const struct {
+        const char *name;
+        int token;
+      } keywords[] = {
+        {"buffer", BUFFER},
+        {"status", STATUS},
+        {"pool", POOL},
+        {"vacuum", VACUUM},
+        {"truncate", TRUNCATE},
+      };
+      for (size_t i = 0; i < sizeof(keywords) / sizeof(keywords[0]); i++) {
+        if (strcmp(text, keywords[i].name) == 0) {
+          return keywords[i].token;
+        }
+      }
+      return 0;
+    }
 #line 585 "../../parser/minisql_lex.c"
 
 #define INITIAL 0
@@ -1170,6 +1191,10 @@ YY_RULE_SETUP
 #line 208 "minisql.l"
 {
   MinisqlParserMovePos(yylineno, yytext);
+  int keyword = MinisqlExtraKeyword(yytext);
+  if (keyword != 0) {
+    return keyword;
+  }
   yylval.syntax_node = CreateSyntaxNode(kNodeIdentifier, yytext);
   return IDENTIFIER;
 }
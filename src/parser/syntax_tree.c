@@ -169,6 +169,14 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeShowBufferStatus:
+      return "kNodeShowBufferStatus";
+    case kNodeSetBufferPool:
+      return "kNodeSetBufferPool";
+    case kNodeVacuum:
+      return "kNodeVacuum";
+    case kNodeTruncateTable:
+      return "kNodeTruncateTable";
     default:
       return "error type";
   }
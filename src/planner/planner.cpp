@@ -24,6 +24,13 @@ void Planner::PlanQuery(pSyntaxNode ast) {
       plan_ = PlanDelete(statement);
       return;
     }
+    case kNodeTruncateTable: {
+      // TRUNCATE TABLE t binds like DELETE FROM t
+      auto statement = make_shared<DeleteStatement>(ast, context_);
+      statement->SyntaxTree2Statement(ast->child_);
+      plan_ = PlanTruncate(statement);
+      return;
+    }
     case kNodeUpdate: {
       auto statement = make_shared<UpdateStatement>(ast, context_);
       statement->SyntaxTree2Statement(ast->child_);
@@ -62,6 +69,10 @@ AbstractPlanNodeRef Planner::PlanInsert(std::shared_ptr<InsertStatement> stateme
 }
 
 AbstractPlanNodeRef Planner::PlanDelete(std::shared_ptr<DeleteStatement> statement) {
+  if (statement->where_ == nullptr) {
+    // every row goes, there is no need to read any of them
+    return PlanTruncate(statement);
+  }
   TableInfo *info = nullptr;
   context_->GetCatalog()->GetTable(statement->table_name_, info);
   auto scan_plan = make_shared<SeqScanPlanNode>(info->GetSchema(), statement->table_name_, statement->where_);
@@ -76,6 +87,12 @@ AbstractPlanNodeRef Planner::PlanUpdate(std::shared_ptr<UpdateStatement> stateme
                                           statement->update_attrs);
 }
 
+AbstractPlanNodeRef Planner::PlanTruncate(std::shared_ptr<DeleteStatement> statement) {
+  TableInfo *info = nullptr;
+  context_->GetCatalog()->GetTable(statement->table_name_, info);
+  return std::make_shared<TruncatePlanNode>(info->GetSchema(), statement->table_name_);
+}
+
 Schema *Planner::MakeOutputSchema(const vector<std::pair<std::string, AbstractExpressionRef>> &exprs) {
   std::vector<Column *> cols;
   cols.reserve(exprs.size());
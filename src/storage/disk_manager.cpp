@@ -1,129 +1,340 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <stdexcept>
 
 #include "glog/logging.h"
 #include "page/bitmap_page.h"
 
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, DiskIOBackend backend) : backend_(backend), file_name_(db_file) {
     std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    // directory or file does not exist
-    if (!db_io_.is_open()) {
-        db_io_.clear();
-        // create a new file
-        std::filesystem::path p = db_file;
-        if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-        db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-        db_io_.close();
-        // reopen with original mode
+    std::filesystem::path p = db_file;
+    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+    if (backend_ != DiskIOBackend::kStream) {
+        db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+        if (db_fd_ < 0) {
+            throw std::exception();
+        }
+        if (backend_ == DiskIOBackend::kIoUring) {
+            io_engine_ = IoUringEngine::Create(IO_URING_QUEUE_DEPTH);
+            if (io_engine_ == nullptr) {
+                LOG(WARNING) << "io_uring is not available, falling back to pread/pwrite";
+                backend_ = DiskIOBackend::kPositional;
+            }
+        }
+    } else {
         db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+        // directory or file does not exist
         if (!db_io_.is_open()) {
-            throw std::exception();
+            db_io_.clear();
+            // create a new file
+            db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
+            db_io_.close();
+            // reopen with original mode
+            db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+            if (!db_io_.is_open()) {
+                throw std::exception();
+            }
         }
     }
+    int file_size = GetFileSize(file_name_);
+    file_size_ = file_size < 0 ? 0 : static_cast<size_t>(file_size);
     ReadPhysicalPage(META_PAGE_ID, meta_data_);
+    // bitmaps are loaded lazily, but the free extent set is rebuilt from the meta page right away
+    DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+    extent_bitmaps_.resize(meta_page->num_extents_);
+    extent_dirty_.assign(meta_page->num_extents_, false);
+    free_extent_pos_.assign(meta_page->num_extents_, -1);
+    for (uint32_t i = meta_page->num_extents_; i > 0; i--) {
+        if (meta_page->extent_used_page_[i - 1] < BITMAP_SIZE) {
+            AddFreeExtent(i - 1);
+        }
+    }
 }
 
-void DiskManager::Close() {
+void DiskManager::FlushMetadata() {
     std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+    for (uint32_t i = 0; i < extent_bitmaps_.size(); i++) {
+        if (extent_dirty_[i]) {
+            WritePhysicalPage(MapExtentId(i), reinterpret_cast<char *>(extent_bitmaps_[i].get()));
+            extent_dirty_[i] = false;
+        }
+    }
     WritePhysicalPage(META_PAGE_ID, meta_data_);
+}
+
+void DiskManager::SetDurabilityMode(DurabilityMode mode, uint32_t group_interval_ms) {
+    StopGroupFlush();
+    if (mode == DurabilityMode::kWriteThrough) {
+        Sync(false);
+        durability_mode_ = mode;
+        return;
+    }
+    durability_mode_ = mode;
+    if (mode == DurabilityMode::kGroup) {
+        stop_group_flush_ = false;
+        group_flusher_ = std::thread(&DiskManager::GroupFlushLoop, this, group_interval_ms);
+    }
+}
+
+void DiskManager::Sync(bool sync_to_disk) {
+    {
+        std::scoped_lock<std::mutex> lock(deferred_latch_);
+        WriteDeferredPages();
+    }
+    if (sync_to_disk) {
+        FlushMetadata();
+        if (backend_ != DiskIOBackend::kStream) {
+            fdatasync(db_fd_);
+        }
+    }
+}
+
+void DiskManager::WriteDeferredPages() {
+    // std::map keeps the pages sorted, so they reach the file in page-id order
+    for (auto &deferred : deferred_writes_) {
+        WritePhysicalPage(deferred.first, deferred.second.get());
+        spare_buffers_.emplace_back(std::move(deferred.second));
+    }
+    deferred_writes_.clear();
+}
+
+void DiskManager::GroupFlushLoop(uint32_t interval_ms) {
+    std::unique_lock<std::mutex> lock(deferred_latch_);
+    while (!stop_group_flush_) {
+        group_flush_cv_.wait_for(lock, std::chrono::milliseconds(interval_ms));
+        if (stop_group_flush_ || deferred_writes_.empty()) continue;
+        lock.unlock();
+        Sync(true);
+        lock.lock();
+    }
+}
+
+void DiskManager::StopGroupFlush() {
+    if (!group_flusher_.joinable()) return;
+    {
+        std::scoped_lock<std::mutex> lock(deferred_latch_);
+        stop_group_flush_ = true;
+    }
+    group_flush_cv_.notify_all();
+    group_flusher_.join();
+}
+
+void DiskManager::Close() {
+    StopGroupFlush();
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
     if (!closed) {
-        db_io_.close();
+        Sync(false);
+        FlushMetadata();
+        if (backend_ != DiskIOBackend::kStream) {
+            // wait for in-flight asynchronous requests before the descriptor goes away
+            io_engine_.reset();
+            close(db_fd_);
+            db_fd_ = -1;
+        } else {
+            db_io_.close();
+        }
         closed = true;
     }
 }
 
-void DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
+bool DiskManager::ReadPage(page_id_t logical_page_id, char *page_data) {
     ASSERT(logical_page_id >= 0, "Invalid page id.");
-    ReadPhysicalPage(MapPageId(logical_page_id), page_data);
+    page_id_t physical_page_id = MapPageId(logical_page_id);
+    if (durability_mode_ != DurabilityMode::kWriteThrough) {
+        std::scoped_lock<std::mutex> lock(deferred_latch_);
+        auto it = deferred_writes_.find(physical_page_id);
+        if (it != deferred_writes_.end()) {
+            memcpy(page_data, it->second.get(), PAGE_SIZE);
+            return true;
+        }
+    }
+    return ReadPhysicalPage(physical_page_id, page_data);
 }
 
-void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
+bool DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
     ASSERT(logical_page_id >= 0, "Invalid page id.");
-    WritePhysicalPage(MapPageId(logical_page_id), page_data);
+    page_id_t physical_page_id = MapPageId(logical_page_id);
+    if (durability_mode_ != DurabilityMode::kWriteThrough) {
+        std::scoped_lock<std::mutex> lock(deferred_latch_);
+        auto &deferred = deferred_writes_[physical_page_id];
+        if (deferred == nullptr) {
+            if (spare_buffers_.empty()) {
+                deferred.reset(new char[PAGE_SIZE]);
+            } else {
+                deferred = std::move(spare_buffers_.back());
+                spare_buffers_.pop_back();
+            }
+        }
+        memcpy(deferred.get(), page_data, PAGE_SIZE);
+        if (deferred_writes_.size() >= MAX_DEFERRED_WRITES) {
+            WriteDeferredPages();
+        }
+        return true;
+    }
+    return WritePhysicalPage(physical_page_id, page_data);
+}
+
+void DiskManager::SubmitRequests(std::vector<DiskRequest> &requests) {
+    // deferred writes live in memory, so every request has to go through the deferred write set
+    if (io_engine_ == nullptr || durability_mode_ != DurabilityMode::kWriteThrough) {
+        for (auto &request : requests) {
+            bool ok = request.is_write_ ? WritePage(request.page_id_, request.data_)
+                                        : ReadPage(request.page_id_, request.data_);
+            if (request.callback_) request.callback_(ok);
+            request.done_.set_value(ok);
+        }
+        return;
+    }
+    std::vector<IoUringEngine::Request> batch;
+    batch.reserve(requests.size());
+    for (auto &request : requests) {
+        ASSERT(request.page_id_ >= 0, "Invalid page id.");
+        page_id_t physical_page_id = MapPageId(request.page_id_);
+        size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+        if (!request.is_write_ && offset >= file_size_.load(std::memory_order_acquire)) {
+            // nothing on disk yet, no need to go through the kernel
+            memset(request.data_, 0, PAGE_SIZE);
+            if (request.callback_) request.callback_(true);
+            request.done_.set_value(true);
+            continue;
+        }
+        // the completion handler must be copyable, so the request itself moves to the heap
+        auto pending = std::make_shared<DiskRequest>(std::move(request));
+        batch.push_back({pending->is_write_, db_fd_, offset, pending->data_, PAGE_SIZE,
+                         [this, pending, physical_page_id](int result) {
+                             CompleteRequest(*pending, physical_page_id, result);
+                         }});
+    }
+    io_engine_->Submit(batch);
+}
+
+std::future<bool> DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data) {
+    std::vector<DiskRequest> requests(1);
+    requests[0].is_write_ = false;
+    requests[0].page_id_ = logical_page_id;
+    requests[0].data_ = page_data;
+    auto future = requests[0].done_.get_future();
+    SubmitRequests(requests);
+    return future;
+}
+
+std::future<bool> DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data) {
+    std::vector<DiskRequest> requests(1);
+    requests[0].is_write_ = true;
+    requests[0].page_id_ = logical_page_id;
+    requests[0].data_ = const_cast<char *>(page_data);
+    auto future = requests[0].done_.get_future();
+    SubmitRequests(requests);
+    return future;
+}
+
+void DiskManager::CompleteRequest(DiskRequest &request, page_id_t physical_page_id, int result) {
+    bool ok = true;
+    if (result != PAGE_SIZE) {
+        if (request.is_write_) {
+            ok = WritePhysicalPagePositional(physical_page_id, request.data_);
+        } else if (result >= 0) {
+            // the file ends inside this page
+            memset(request.data_ + result, 0, PAGE_SIZE - result);
+        } else {
+            ok = ReadPhysicalPagePositional(physical_page_id, request.data_);
+        }
+    } else if (request.is_write_) {
+        size_t end = (static_cast<size_t>(physical_page_id) + 1) * PAGE_SIZE;
+        size_t cur = file_size_.load(std::memory_order_relaxed);
+        while (cur < end && !file_size_.compare_exchange_weak(cur, end, std::memory_order_release)) {
+        }
+    }
+    if (request.callback_) request.callback_(ok);
+    request.done_.set_value(ok);
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetExtentBitmap(uint32_t extent_id) {
+    if (extent_bitmaps_[extent_id] == nullptr) {
+        extent_bitmaps_[extent_id] = std::make_unique<BitmapPage<PAGE_SIZE>>();
+        ReadPhysicalPage(MapExtentId(extent_id), reinterpret_cast<char *>(extent_bitmaps_[extent_id].get()));
+    }
+    return extent_bitmaps_[extent_id].get();
+}
+
+void DiskManager::AddFreeExtent(uint32_t extent_id) {
+    if (free_extent_pos_[extent_id] >= 0) return;
+    free_extent_pos_[extent_id] = free_extents_.size();
+    free_extents_.push_back(extent_id);
+}
+
+void DiskManager::RemoveFreeExtent(uint32_t extent_id) {
+    int32_t pos = free_extent_pos_[extent_id];
+    if (pos < 0) return;
+    // swap with the last entry so that removal stays O(1)
+    uint32_t last = free_extents_.back();
+    free_extents_[pos] = last;
+    free_extent_pos_[last] = pos;
+    free_extents_.pop_back();
+    free_extent_pos_[extent_id] = -1;
 }
 
 /**
- * TODO: Student Implement
- * 0. Read meta page
- * 1. Find a free page from bitmap pages
- * 2. Update bitmap page
- * 3. Write bitmap page back to disk
- * 4. Return page id
+ * Allocation works on the cached bitmaps only, dirty bitmaps reach the disk in FlushMetadata.
  * @return
  */
 page_id_t DiskManager::AllocatePage() {
-    DiskFileMetaPage *meta_data_ = reinterpret_cast<DiskFileMetaPage *>(GetMetaData());
-    uint32_t num_allocated_pages_ = meta_data_->num_allocated_pages_;
-    uint32_t num_extents_ = meta_data_->num_extents_;
-    uint32_t allocated_extents_id = 0;
-    for (allocated_extents_id = 0; allocated_extents_id < num_extents_; allocated_extents_id++) {
-        if (meta_data_->extent_used_page_[allocated_extents_id] < BitmapPage<4096>::GetMaxSupportedSize()) {
-            break;
-        }
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+    DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(GetMetaData());
+    if (free_extents_.empty()) {
+        // every extent is full, open a new one
+        uint32_t new_extent_id = meta_page->num_extents_;
+        meta_page->extent_used_page_[new_extent_id] = 0;
+        meta_page->num_extents_++;
+        extent_bitmaps_.emplace_back(std::make_unique<BitmapPage<PAGE_SIZE>>());
+        extent_dirty_.push_back(true);
+        free_extent_pos_.push_back(-1);
+        AddFreeExtent(new_extent_id);
     }
-    uint32_t allocated_extents_frame_id = 1 + allocated_extents_id * (BitmapPage<4096>::GetMaxSupportedSize() + 1);
-    if (allocated_extents_id == num_extents_) {
-        // no free page
-        auto new_extent = new BitmapPage<4096>();
-        WritePhysicalPage(allocated_extents_frame_id, reinterpret_cast<char *>(new_extent));
-        meta_data_->extent_used_page_[num_extents_] = 0;
-        meta_data_->num_extents_++;
-        num_extents_++;
+    uint32_t extent_id = free_extents_.back();
+    uint32_t page_offset = 0;
+    bool allocated = GetExtentBitmap(extent_id)->AllocatePage(page_offset);
+    ASSERT(allocated, "Extent in free list has no free page.");
+    extent_dirty_[extent_id] = true;
+    meta_page->num_allocated_pages_++;
+    if (++meta_page->extent_used_page_[extent_id] == BITMAP_SIZE) {
+        RemoveFreeExtent(extent_id);
     }
-    auto allocated_extent = new BitmapPage<4096>();
-    ReadPhysicalPage(allocated_extents_frame_id, reinterpret_cast<char *>(allocated_extent));
-    uint32_t allocated_page_extent_offset = -1;
-    allocated_extent->AllocatePage(allocated_page_extent_offset);
-    meta_data_->num_allocated_pages_++;
-    meta_data_->extent_used_page_[allocated_extents_id]++;
-    WritePhysicalPage(allocated_extents_frame_id, reinterpret_cast<char *>(allocated_extent));
-    return allocated_extents_id * BitmapPage<4096>::GetMaxSupportedSize() + allocated_page_extent_offset;
+    return extent_id * BITMAP_SIZE + page_offset;
 }
 
-/**
- * TODO: Student Implement
- */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
-    // ASSERT(false, "Not implemented yet.");
-    DiskFileMetaPage *meta_data_ = reinterpret_cast<DiskFileMetaPage *>(GetMetaData());
-    uint32_t num_allocated_pages_ = meta_data_->num_allocated_pages_;
-    uint32_t num_extents_ = meta_data_->num_extents_;
-    uint32_t deallocated_extents_id = logical_page_id / BitmapPage<4096>::GetMaxSupportedSize();
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+    DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(GetMetaData());
+    uint32_t extent_id = logical_page_id / BITMAP_SIZE;
     //free a page not allocated
-    if (deallocated_extents_id >= num_extents_) {
+    if (extent_id >= meta_page->num_extents_) {
         ASSERT(false, "try free in invalid extent");
     }
-    uint32_t deallocated_extents_frame_id = 1 + deallocated_extents_id * (BitmapPage<4096>::GetMaxSupportedSize() + 1);
-    auto deallocated_extent = new BitmapPage<4096>();
-    ReadPhysicalPage(deallocated_extents_frame_id, reinterpret_cast<char *>(deallocated_extent)); //read from disk
-    ASSERT(deallocated_extent != nullptr, "bitmap_page is nullptr");
-    deallocated_extent->DeAllocatePage(logical_page_id % BitmapPage<4096>::GetMaxSupportedSize());
-//    if (meta_data_->num_allocated_pages_ - 1 == logical_page_id)
-    meta_data_->num_allocated_pages_--;
-    meta_data_->extent_used_page_[deallocated_extents_id]--;
-    WritePhysicalPage(deallocated_extents_frame_id, reinterpret_cast<char *>(deallocated_extent));  //write back
+    if (!GetExtentBitmap(extent_id)->DeAllocatePage(logical_page_id % BITMAP_SIZE)) {
+        return;
+    }
+    extent_dirty_[extent_id] = true;
+    meta_page->num_allocated_pages_--;
+    meta_page->extent_used_page_[extent_id]--;
+    AddFreeExtent(extent_id);
 }
 
-/**
- * TODO: Student Implement
- */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-    DiskFileMetaPage *meta_data_ = reinterpret_cast<DiskFileMetaPage *>(GetMetaData());
-    uint32_t num_allocated_pages_ = meta_data_->num_allocated_pages_;  //not used
-    uint32_t num_extents_ = meta_data_->num_extents_;
-    uint32_t checked_extents_id = logical_page_id / BitmapPage<4096>::GetMaxSupportedSize();
-    uint32_t checked_extents_frame_id = 1 + checked_extents_id * (BitmapPage<4096>::GetMaxSupportedSize() + 1);
-    if (checked_extents_id >= num_extents_) {
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+    DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(GetMetaData());
+    uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+    if (extent_id >= meta_page->num_extents_) {
         return true;
     }
-    auto checked_extent = new BitmapPage<4096>();
-    ReadPhysicalPage(checked_extents_frame_id, reinterpret_cast<char *>(checked_extent));
-    ASSERT(checked_extent != nullptr, "bitmap_page is nullptr");
-    return checked_extent->IsPageFree(logical_page_id % BitmapPage<4096>::GetMaxSupportedSize());
+    return GetExtentBitmap(extent_id)->IsPageFree(logical_page_id % BITMAP_SIZE);
 }
 
 /**
@@ -141,7 +352,71 @@ int DiskManager::GetFileSize(const std::string &file_name) {
     return rc == 0 ? stat_buf.st_size : -1;
 }
 
-void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
+bool DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
+    if (backend_ != DiskIOBackend::kStream) {
+        return ReadPhysicalPagePositional(physical_page_id, page_data);
+    }
+    return ReadPhysicalPageStream(physical_page_id, page_data);
+}
+
+bool DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
+    if (backend_ != DiskIOBackend::kStream) {
+        return WritePhysicalPagePositional(physical_page_id, page_data);
+    }
+    return WritePhysicalPageStream(physical_page_id, page_data);
+}
+
+bool DiskManager::ReadPhysicalPagePositional(page_id_t physical_page_id, char *page_data) {
+    size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+    // the cached length replaces the stat() of the stream path; pages beyond it read as zeros
+    if (offset >= file_size_.load(std::memory_order_acquire)) {
+        memset(page_data, 0, PAGE_SIZE);
+        return true;
+    }
+    bool ok = true;
+    size_t read_count = 0;
+    while (read_count < PAGE_SIZE) {
+        ssize_t rc = pread(db_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            LOG(ERROR) << "I/O error while reading page " << physical_page_id << ": " << strerror(errno);
+            ok = false;
+            break;
+        }
+        if (rc == 0) break;
+        read_count += rc;
+    }
+    if (read_count < PAGE_SIZE) {
+#ifdef ENABLE_BPM_DEBUG
+        LOG(INFO) << "Read less than a page" << std::endl;
+#endif
+        memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    }
+    return ok;
+}
+
+bool DiskManager::WritePhysicalPagePositional(page_id_t physical_page_id, const char *page_data) {
+    size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+    size_t write_count = 0;
+    while (write_count < PAGE_SIZE) {
+        ssize_t rc = pwrite(db_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+        if (rc < 0) {
+            if (errno == EINTR) continue;
+            LOG(ERROR) << "I/O error while writing page " << physical_page_id << ": " << strerror(errno);
+            return false;
+        }
+        write_count += rc;
+    }
+    // pwrite hands the data straight to the kernel, so there is no user space buffer to flush
+    size_t end = offset + PAGE_SIZE;
+    size_t cur = file_size_.load(std::memory_order_relaxed);
+    while (cur < end && !file_size_.compare_exchange_weak(cur, end, std::memory_order_release)) {
+    }
+    return true;
+}
+
+bool DiskManager::ReadPhysicalPageStream(page_id_t physical_page_id, char *page_data) {
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
     int offset = physical_page_id * PAGE_SIZE;
     // check if read beyond file length
     if (offset >= GetFileSize(file_name_)) {
@@ -161,10 +436,16 @@ void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data)
 #endif
             memset(page_data + read_count, 0, PAGE_SIZE - read_count);
         }
+        if (db_io_.bad()) {
+            LOG(ERROR) << "I/O error while reading";
+            return false;
+        }
     }
+    return true;
 }
 
-void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
+bool DiskManager::WritePhysicalPageStream(page_id_t physical_page_id, const char *page_data) {
+    std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
     size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
     // set write cursor to offset
     db_io_.seekp(offset);
@@ -172,8 +453,11 @@ void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page
     // check for I/O error
     if (db_io_.bad()) {
         LOG(ERROR) << "I/O error while writing";
-        return;
+        return false;
     }
     // needs to flush to keep disk file in sync
     db_io_.flush();
-}
\ No newline at end of file
+    size_t end = offset + PAGE_SIZE;
+    if (end > file_size_) file_size_ = end;
+    return true;
+}
@@ -0,0 +1,174 @@
+#include "storage/free_space_map.h"
+
+#include "glog/logging.h"
+
+void FreeSpaceMap::Load() {
+    if (loaded_) {
+        return;
+    }
+    loaded_ = true;
+    page_id_t map_page_id = first_page_id_;
+    while (map_page_id != INVALID_PAGE_ID) {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(map_page_id);
+        if (!guard) {
+            LOG(WARNING) << "cannot read free space map page " << map_page_id;
+            break;
+        }
+        auto map_page = guard.As<FreeSpaceMapPage>();
+        auto map_index = static_cast<uint32_t>(map_pages_.size());
+        for (uint32_t slot = 0; slot < map_page->GetCount(); slot++) {
+            if (map_page->GetHeapPageId(slot) == INVALID_PAGE_ID) {
+                free_slots_.push_back({map_index, slot, 0});
+            } else {
+                entries_[map_page->GetHeapPageId(slot)] = {map_index, slot, map_page->GetCategory(slot)};
+            }
+        }
+        map_pages_.push_back(map_page_id);
+        max_categories_.push_back(map_page->GetMaxCategory());
+        map_page_id = map_page->GetNextPageId();
+    }
+}
+
+page_id_t FreeSpaceMap::GetAppendPage() {
+    if (!map_pages_.empty()) {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(map_pages_.back());
+        if (guard && !guard.As<FreeSpaceMapPage>()->IsFull()) {
+            return map_pages_.back();
+        }
+    }
+    page_id_t new_page_id;
+    WritePageGuard new_guard = buffer_pool_manager_->NewPageGuarded(new_page_id);
+    if (!new_guard) {
+        return INVALID_PAGE_ID;
+    }
+    new_guard.AsMut<FreeSpaceMapPage>()->Init();
+    if (map_pages_.empty()) {
+        first_page_id_ = new_page_id;
+    } else {
+        WritePageGuard last_guard = buffer_pool_manager_->FetchPageWrite(map_pages_.back());
+        if (!last_guard) {
+            new_guard.Drop();
+            buffer_pool_manager_->DeletePage(new_page_id);
+            return INVALID_PAGE_ID;
+        }
+        last_guard.AsMut<FreeSpaceMapPage>()->SetNextPageId(new_page_id);
+    }
+    map_pages_.push_back(new_page_id);
+    max_categories_.push_back(0);
+    return new_page_id;
+}
+
+void FreeSpaceMap::Update(page_id_t heap_page_id, uint32_t free_space) {
+    Load();
+    uint8_t category = FreeSpaceMapPage::ToCategory(free_space);
+    auto it = entries_.find(heap_page_id);
+    if (it != entries_.end()) {
+        Entry &entry = it->second;
+        if (entry.category_ == category) {
+            return;
+        }
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_pages_[entry.map_index_]);
+        if (!guard) {
+            return;
+        }
+        auto map_page = guard.AsMut<FreeSpaceMapPage>();
+        map_page->SetCategory(entry.slot_, category);
+        if (category > max_categories_[entry.map_index_]) {
+            max_categories_[entry.map_index_] = category;
+        } else if (entry.category_ == max_categories_[entry.map_index_]) {
+            max_categories_[entry.map_index_] = map_page->GetMaxCategory();
+        }
+        entry.category_ = category;
+        return;
+    }
+    if (!free_slots_.empty()) {
+        Entry entry = free_slots_.back();
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_pages_[entry.map_index_]);
+        if (!guard) {
+            return;
+        }
+        free_slots_.pop_back();
+        auto map_page = guard.AsMut<FreeSpaceMapPage>();
+        map_page->SetHeapPageId(entry.slot_, heap_page_id);
+        map_page->SetCategory(entry.slot_, category);
+        entry.category_ = category;
+        entries_[heap_page_id] = entry;
+        if (category > max_categories_[entry.map_index_]) {
+            max_categories_[entry.map_index_] = category;
+        }
+        return;
+    }
+    page_id_t map_page_id = GetAppendPage();
+    if (map_page_id == INVALID_PAGE_ID) {
+        LOG(WARNING) << "no free frame for a free space map page";
+        return;
+    }
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_page_id);
+    auto map_index = static_cast<uint32_t>(map_pages_.size() - 1);
+    uint32_t slot = guard.AsMut<FreeSpaceMapPage>()->Append(heap_page_id, category);
+    entries_[heap_page_id] = {map_index, slot, category};
+    if (category > max_categories_[map_index]) {
+        max_categories_[map_index] = category;
+    }
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t size) {
+    Load();
+    // the category is rounded down, so a page qualifies once its category covers size rounded up
+    uint32_t needed = (size + FreeSpaceMapPage::CATEGORY_BYTES - 1) / FreeSpaceMapPage::CATEGORY_BYTES;
+    if (needed > 255 || map_pages_.empty()) {
+        return INVALID_PAGE_ID;
+    }
+    for (size_t i = 0; i < map_pages_.size(); i++) {
+        size_t map_index = (search_start_ + i) % map_pages_.size();
+        if (max_categories_[map_index] < needed) {
+            continue;
+        }
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(map_pages_[map_index]);
+        if (!guard) {
+            continue;
+        }
+        auto map_page = guard.As<FreeSpaceMapPage>();
+        uint32_t slot = map_page->FindSlot(static_cast<uint8_t>(needed));
+        if (slot < map_page->GetCount()) {
+            search_start_ = map_index;
+            return map_page->GetHeapPageId(slot);
+        }
+        max_categories_[map_index] = map_page->GetMaxCategory();
+    }
+    return INVALID_PAGE_ID;
+}
+
+void FreeSpaceMap::Remove(page_id_t heap_page_id) {
+    Load();
+    auto it = entries_.find(heap_page_id);
+    if (it == entries_.end()) {
+        return;
+    }
+    Entry entry = it->second;
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(map_pages_[entry.map_index_]);
+    if (!guard) {
+        return;
+    }
+    auto map_page = guard.AsMut<FreeSpaceMapPage>();
+    map_page->SetHeapPageId(entry.slot_, INVALID_PAGE_ID);
+    map_page->SetCategory(entry.slot_, 0);
+    if (entry.category_ == max_categories_[entry.map_index_]) {
+        max_categories_[entry.map_index_] = map_page->GetMaxCategory();
+    }
+    entries_.erase(it);
+    free_slots_.push_back({entry.map_index_, entry.slot_, 0});
+}
+
+void FreeSpaceMap::Free() {
+    Load();
+    for (auto map_page_id : map_pages_) {
+        buffer_pool_manager_->DeletePage(map_page_id);
+    }
+    first_page_id_ = INVALID_PAGE_ID;
+    map_pages_.clear();
+    max_categories_.clear();
+    entries_.clear();
+    free_slots_.clear();
+    search_start_ = 0;
+}
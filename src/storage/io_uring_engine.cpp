@@ -0,0 +1,190 @@
+#include "storage/io_uring_engine.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "glog/logging.h"
+
+static int SysIoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int SysIoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+std::unique_ptr<IoUringEngine> IoUringEngine::Create(unsigned queue_depth) {
+  std::unique_ptr<IoUringEngine> engine(new IoUringEngine());
+  if (!engine->Setup(queue_depth)) {
+    return nullptr;
+  }
+  engine->reaper_ = std::thread(&IoUringEngine::ReapLoop, engine.get());
+  return engine;
+}
+
+bool IoUringEngine::Setup(unsigned queue_depth) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_fd_ = SysIoUringSetup(queue_depth, &params);
+  if (ring_fd_ < 0) {
+    LOG(WARNING) << "io_uring_setup failed: " << strerror(errno);
+    return false;
+  }
+  depth_ = params.sq_entries;
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_mmap) {
+    sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    cq_ring_size_ = sq_ring_size_;
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    close(ring_fd_);
+    return false;
+  }
+  if (single_mmap) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      cq_ring_ = nullptr;
+      munmap(sq_ring_, sq_ring_size_);
+      close(ring_fd_);
+      return false;
+    }
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    if (cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+    return false;
+  }
+  sqes_ = reinterpret_cast<io_uring_sqe *>(sqes);
+  char *sq = reinterpret_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  char *cq = reinterpret_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  return true;
+}
+
+IoUringEngine::~IoUringEngine() {
+  if (reaper_.joinable()) {
+    Drain();
+    // wake the reaper up with a nop carrying no request
+    {
+      std::scoped_lock<std::mutex> lock(submit_latch_);
+      stop_ = true;
+      unsigned tail = *sq_tail_;
+      unsigned index = tail & *sq_mask_;
+      io_uring_sqe *sqe = &sqes_[index];
+      memset(sqe, 0, sizeof(io_uring_sqe));
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = 0;
+      sq_array_[index] = index;
+      __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+      Enter(1);
+    }
+    reaper_.join();
+  }
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0) close(ring_fd_);
+}
+
+void IoUringEngine::Submit(std::vector<Request> &requests) {
+  std::unique_lock<std::mutex> lock(submit_latch_);
+  unsigned pending = 0;
+  for (auto &request : requests) {
+    // keep at most depth_ requests in flight so neither ring can overflow
+    while (inflight_.load() >= depth_) {
+      if (pending > 0) {
+        Enter(pending);
+        pending = 0;
+      }
+      space_cv_.wait(lock);
+    }
+    auto *op = new Request(std::move(request));
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = op->is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+    sqe->fd = op->fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(op->data_);
+    sqe->len = op->length_;
+    sqe->off = op->offset_;
+    sqe->user_data = reinterpret_cast<uint64_t>(op);
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    inflight_++;
+    pending++;
+  }
+  if (pending > 0) {
+    Enter(pending);
+  }
+}
+
+void IoUringEngine::Enter(unsigned to_submit) {
+  while (to_submit > 0) {
+    int rc = SysIoUringEnter(ring_fd_, to_submit, 0, 0);
+    if (rc < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+      LOG(FATAL) << "io_uring_enter failed: " << strerror(errno);
+    }
+    to_submit -= rc;
+  }
+}
+
+void IoUringEngine::Drain() {
+  std::unique_lock<std::mutex> lock(submit_latch_);
+  space_cv_.wait(lock, [this] { return inflight_.load() == 0; });
+}
+
+void IoUringEngine::ReapLoop() {
+  while (true) {
+    // only this thread advances the completion head
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      if (stop_ && inflight_.load() == 0) {
+        return;
+      }
+      int rc = SysIoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      if (rc < 0 && errno != EINTR) {
+        LOG(FATAL) << "io_uring_enter failed while waiting: " << strerror(errno);
+      }
+      continue;
+    }
+    io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+    uint64_t user_data = cqe->user_data;
+    int result = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    if (user_data == 0) {
+      continue;
+    }
+    auto *op = reinterpret_cast<Request *>(user_data);
+    op->done_(result);
+    delete op;
+    {
+      std::scoped_lock<std::mutex> lock(submit_latch_);
+      inflight_--;
+    }
+    space_cv_.notify_all();
+  }
+}
@@ -1,5 +1,13 @@
 #include "storage/table_heap.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
 #include "common/config.h"
+#include "glog/logging.h"
 #include "storage/table_iterator.h"
 
 /**
@@ -21,78 +29,91 @@
  */
 
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-    // Step1: Find the first page with enough space, if no page has enough space, create a new page.
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    uint32_t serialized_size = row.GetSerializedSize(schema_);
+    if (serialized_size > TablePage::SIZE_MAX_ROW) {
+        return false;
+    }
+    // Step1: a page the free space map says has room, an entry that turns out to be wrong is corrected and skipped
+    page_id_t page_id;
+    while ((page_id = free_space_map_.FindPage(serialized_size)) != INVALID_PAGE_ID) {
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id);
+        if (!guard) {
+            free_space_map_.Update(page_id, 0);
+            continue;
+        }
+        auto page = guard.As<TablePage>();
+        bool inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+        free_space_map_.Update(page_id, page->GetMaxInsertSize());
+        if (inserted) {
+            guard.MarkDirty();
+            return true;
+        }
+    }
+    // Step2: the last page, a heap written before it had a free space map may not have it in the map
+    if (!last_page_found_) {
+        FindLastPage();
+    }
+    WritePageGuard last_guard;
     if (last_page_id_ != INVALID_PAGE_ID) {
-        auto last_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
-        if (last_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
-            buffer_pool_manager_->UnpinPage(last_page_id_, true);
+        last_guard = buffer_pool_manager_->FetchPageWrite(last_page_id_);
+        if (!last_guard) {
+            return false;
+        }
+        auto last_page = last_guard.AsMut<TablePage>();
+        bool inserted = last_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+        free_space_map_.Update(last_page_id_, last_page->GetMaxInsertSize());
+        if (inserted) {
             return true;
         }
-        page_id_t new_page_id = INVALID_PAGE_ID;
-        auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
-        ASSERT(new_page_id != INVALID_PAGE_ID, "new page fail in Insert tuple");
-        new_page->Init(new_page_id, last_page_id_, log_manager_, txn);
-        new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
-        last_page->SetNextPageId(new_page_id);
-        //unpin the page
-        buffer_pool_manager_->UnpinPage(last_page_id_, true);
-        buffer_pool_manager_->UnpinPage(new_page_id, true);
-        last_page_id_ = new_page_id;
-        return true;
+    }
+    // Step3: append a new page
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    WritePageGuard new_guard = buffer_pool_manager_->NewPageGuarded(new_page_id);
+    if (!new_guard) {
+        LOG(WARNING) << "no free frame for a new table page";
+        return false;
+    }
+    auto new_page = new_guard.AsMut<TablePage>();
+    new_page->Init(new_page_id, last_page_id_, log_manager_, txn);
+    new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+    free_space_map_.Update(new_page_id, new_page->GetMaxInsertSize());
+    if (last_guard) {
+        last_guard.AsMut<TablePage>()->SetNextPageId(new_page_id);
     } else {
-        page_id_t traverse_page_id = first_page_id_;
-        while (traverse_page_id != INVALID_PAGE_ID) {
-            auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(traverse_page_id));
-            // TODO: if need multiple threads, need to add WLatch here
-            if (page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_)) {
-                buffer_pool_manager_->UnpinPage(traverse_page_id, true);
-                return true;
-            }
-            buffer_pool_manager_->UnpinPage(traverse_page_id, false);
-            if (page->GetNextPageId() != INVALID_PAGE_ID)
-                traverse_page_id = page->GetNextPageId();
-            else
-                break;
-        }
-        TablePage *new_page = nullptr;
-        page_id_t new_page_id = INVALID_PAGE_ID;
-        while (true) {
-            // TODO: didn't understand why it's possible to have nullptr here
-            new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
-            if (new_page == nullptr) {
-                sleep(1);
-                continue;
-            }
+        first_page_id_ = new_page_id;
+    }
+    last_page_id_ = new_page_id;
+    return true;
+}
+
+void TableHeap::FindLastPage() {
+    // without a saved last page this reads every page of the heap, keep it from flushing the buffer pool
+    BufferAccessStrategy strategy;
+    page_id_t traverse_page_id = last_page_id_ != INVALID_PAGE_ID ? last_page_id_ : first_page_id_;
+    last_page_found_ = true;
+    while (traverse_page_id != INVALID_PAGE_ID) {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(traverse_page_id, &strategy);
+        if (!guard) {
             break;
         }
-        // if there is no page in the table_heap
-        if (traverse_page_id == INVALID_PAGE_ID) {
-            first_page_id_ = new_page_id;
-            last_page_id_ = new_page_id;
-        }
-        // TODO: if need multiple threads, need to add lock here
-        new_page->Init(new_page_id, traverse_page_id, log_manager_, txn);
-        new_page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
-        auto rear_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(traverse_page_id));
-        rear_page->SetNextPageId(new_page_id);
-        buffer_pool_manager_->UnpinPage(traverse_page_id, true);
-        buffer_pool_manager_->UnpinPage(new_page_id, true);
-        return true;
+        last_page_id_ = traverse_page_id;
+        traverse_page_id = guard.As<TablePage>()->GetNextPageId();
     }
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     // Find the page which contains the tuple.
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
     // If the page could not be found, then abort the transaction.
-    if (page == nullptr) {
+    if (!guard) {
         return false;
     }
     // Otherwise, mark the tuple as deleted.
-//  page->WLatch();
-    page->MarkDelete(rid, txn, lock_manager_, log_manager_);
-//  page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    if (guard.AsMut<TablePage>()->MarkDelete(rid, txn, lock_manager_, log_manager_)) {
+        pending_deletes_++;
+    }
     return true;
 }
 
@@ -100,30 +121,27 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
  * TODO: Test
  */
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     // Step1: Find the page which contains the tuple.
-    // Find the page which contains the tuple.
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
     // If the page could not be found, then abort the transaction.
-    if (page == nullptr) {
+    if (!guard) {
         return false;
     }
     // Step2: Update the tuple in the page.
-//  page->WLatch();
     // step 2.0 get the old tuple
     Row old_tuple = Row(rid);
-//  page->GetTuple(&old_tuple, schema_, txn, lock_manager_);
-    uint8_t error_code = page->UpdateTuple(row, &old_tuple, schema_, txn, lock_manager_, log_manager_);
+    uint8_t error_code = guard.AsMut<TablePage>()->UpdateTuple(row, &old_tuple, schema_, txn, lock_manager_,
+                                                               log_manager_);
     if (error_code == 0) {
-//    page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+        free_space_map_.Update(rid.GetPageId(), guard.As<TablePage>()->GetMaxInsertSize());
         return true;
     } else if (error_code == 1) {
-//    page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
         return false;
     }
+    // the new tuple does not fit, MarkDelete latches the page itself
+    guard.Drop();
     MarkDelete(rid, txn);
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
     InsertTuple(row, txn);
     return true;
 }
@@ -132,48 +150,232 @@ bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
  * TODO: Test
  */
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     // Find the page which contains the tuple.
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-    assert(page != nullptr);
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+    assert(guard.IsValid());
     // Otherwise, apply the tuple as deleted.
-//  page->WLatch();
-    page->ApplyDelete(rid, txn, log_manager_);
-//  page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    guard.AsMut<TablePage>()->ApplyDelete(rid, txn, log_manager_);
+    // the space is free again, later inserts may use it
+    free_space_map_.Update(rid.GetPageId(), guard.As<TablePage>()->GetMaxInsertSize());
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     // Find the page which contains the tuple.
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-    assert(page != nullptr);
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(rid.GetPageId());
+    assert(guard.IsValid());
     // Rollback to delete.
-//  page->WLatch();
-    page->RollbackDelete(rid, txn, log_manager_);
-//  page->WUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+    guard.AsMut<TablePage>()->RollbackDelete(rid, txn, log_manager_);
 }
 
 /**
  * TODO: Test
  */
 bool TableHeap::GetTuple(Row *row, Transaction *txn) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(row->GetRowId().GetPageId());
     // If the page could not be found, then abort the transaction.
-    if (page == nullptr) {
+    if (!guard) {
         return false;
     }
-    auto ret = page->GetTuple(row, schema_, txn, lock_manager_);
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-    return ret;
+    return guard.As<TablePage>()->GetTuple(row, schema_, txn, lock_manager_);
+}
+
+uint32_t TableHeap::Vacuum(Transaction *txn, uint32_t *freed_pages) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    // every page is visited once, keep the walk from flushing the rest of the buffer pool
+    BufferAccessStrategy strategy;
+    uint32_t removed = 0;
+    uint32_t freed = 0;
+    WritePageGuard prev_guard;
+    page_id_t prev_page_id = INVALID_PAGE_ID;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id, &strategy);
+        if (!guard) {
+            LOG(WARNING) << "vacuum cannot read table page " << page_id;
+            break;
+        }
+        auto page = guard.AsMut<TablePage>();
+        removed += page->ApplyDeleteAll(txn, log_manager_);
+        page_id_t next_page_id = page->GetNextPageId();
+        RowId rid;
+        if (page_id == first_page_id_ || page->GetFirstTupleRid(&rid)) {
+            free_space_map_.Update(page_id, page->GetMaxInsertSize());
+            // latches are taken along the chain, the previous page is only released once the next one is held
+            prev_guard = std::move(guard);
+            prev_page_id = page_id;
+            page_id = next_page_id;
+            continue;
+        }
+        // the page is empty, link its neighbours to each other and give it back
+        prev_guard.AsMut<TablePage>()->SetNextPageId(next_page_id);
+        if (next_page_id != INVALID_PAGE_ID) {
+            WritePageGuard next_guard = buffer_pool_manager_->FetchPageWrite(next_page_id, &strategy);
+            if (!next_guard) {
+                // leave the page in the chain, it stays usable for inserts
+                prev_guard.AsMut<TablePage>()->SetNextPageId(page_id);
+                free_space_map_.Update(page_id, page->GetMaxInsertSize());
+                prev_guard = std::move(guard);
+                prev_page_id = page_id;
+                page_id = next_page_id;
+                continue;
+            }
+            next_guard.AsMut<TablePage>()->SetPrevPageId(prev_page_id);
+        }
+        free_space_map_.Remove(page_id);
+        guard.Drop();
+        if (!buffer_pool_manager_->DeletePage(page_id)) {
+            LOG(WARNING) << "vacuum cannot delete table page " << page_id << ", it is still pinned";
+        }
+        freed++;
+        page_id = next_page_id;
+    }
+    if (page_id == INVALID_PAGE_ID) {
+        // the whole chain was walked, so its end is known
+        last_page_id_ = prev_page_id;
+        last_page_found_ = true;
+        pending_deletes_ = 0;
+    }
+    if (freed_pages != nullptr) {
+        *freed_pages = freed;
+    }
+    return removed;
+}
+
+uint32_t TableHeap::Truncate(Transaction *txn) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    BufferAccessStrategy strategy;
+    uint32_t removed = 0;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(page_id, &strategy);
+        if (!guard) {
+            LOG(WARNING) << "truncate cannot read table page " << page_id;
+            break;
+        }
+        auto page = guard.AsMut<TablePage>();
+        removed += page->GetLiveTupleCount();
+        page_id_t next_page_id = page->GetNextPageId();
+        if (page_id == first_page_id_) {
+            page->Init(page_id, INVALID_PAGE_ID, log_manager_, txn);
+        } else {
+            guard.Drop();
+            buffer_pool_manager_->DeletePage(page_id);
+        }
+        page_id = next_page_id;
+    }
+    free_space_map_.Free();
+    last_page_id_ = first_page_id_;
+    last_page_found_ = true;
+    pending_deletes_ = 0;
+    if (first_page_id_ != INVALID_PAGE_ID) {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(first_page_id_);
+        if (guard) {
+            free_space_map_.Update(first_page_id_, guard.As<TablePage>()->GetMaxInsertSize());
+        }
+    }
+    return removed;
+}
+
+bool TableHeap::PartitionedScan(size_t num_workers, const std::function<void(size_t worker, Row &row)> &visit) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    // every page handed out stays pinned until its worker is done with it: up to two queued batches per worker, the
+    // batch each worker holds and the one being filled. Keep all of them within a quarter of the pool, with fewer
+    // workers and smaller batches on a small pool, so the scan neither runs out of frames nor evicts the rest of it
+    const size_t max_pinned = std::max<size_t>(4, buffer_pool_manager_->GetPoolSize() / 4);
+    const size_t batch_pages = std::min<size_t>(SCAN_BATCH_PAGES, std::max<size_t>(1, max_pinned / 4));
+    num_workers = std::max<size_t>(1, std::min(num_workers, (max_pinned / batch_pages - 1) / 3));
+    const size_t max_queued = 2 * num_workers;
+    std::mutex latch;
+    std::condition_variable cv;
+    std::deque<std::vector<BasicPageGuard>> batches;
+    bool walk_done = false;
+    auto work = [&](size_t worker) {
+        BufferPoolStatsScope worker_stats_scope(buffer_pool_counters_);
+        while (true) {
+            std::vector<BasicPageGuard> batch;
+            {
+                std::unique_lock<std::mutex> lock(latch);
+                cv.wait(lock, [&] { return !batches.empty() || walk_done; });
+                if (batches.empty()) {
+                    return;
+                }
+                batch = std::move(batches.front());
+                batches.pop_front();
+            }
+            cv.notify_all();
+            for (auto &pinned: batch) {
+                ReadPageGuard guard(std::move(pinned));
+                auto page = guard.As<TablePage>();
+                RowId row_id;
+                bool found = page->GetFirstTupleRid(&row_id);
+                while (found) {
+                    Row row(row_id);
+                    page->GetTuple(&row, schema_, nullptr, lock_manager_);
+                    visit(worker, row);
+                    found = page->GetNextTupleRid(row_id, &row_id);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < num_workers; i++) {
+        workers.emplace_back(work, i);
+    }
+    // the walk only reads the next page ids. The ring has room for every page pinned at once, so the frame it recycles
+    // next is free again unless one worker is still on a batch a whole ring behind, only then a frame of the rest of
+    // the pool is taken
+    BufferAccessStrategy strategy((max_queued + num_workers + 1) * batch_pages);
+    std::vector<BasicPageGuard> batch;
+    page_id_t page_id = first_page_id_;
+    bool complete = true;
+    while (page_id != INVALID_PAGE_ID) {
+        BasicPageGuard guard = buffer_pool_manager_->FetchPageBasic(page_id, &strategy);
+        if (!guard) {
+            // the rest of the chain is out of reach, the workers still finish the pages handed out
+            LOG(WARNING) << "partitioned scan cannot read table page " << page_id;
+            complete = false;
+            page_id = INVALID_PAGE_ID;
+        } else {
+            guard.GetPage()->RLatch();
+            page_id = guard.As<TablePage>()->GetNextPageId();
+            guard.GetPage()->RUnlatch();
+            batch.push_back(std::move(guard));
+        }
+        if (batch.size() == batch_pages || (page_id == INVALID_PAGE_ID && !batch.empty())) {
+            {
+                std::unique_lock<std::mutex> lock(latch);
+                cv.wait(lock, [&] { return batches.size() < max_queued; });
+                batches.push_back(std::move(batch));
+            }
+            cv.notify_all();
+            batch.clear();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(latch);
+        walk_done = true;
+    }
+    cv.notify_all();
+    for (auto &worker: workers) {
+        worker.join();
+    }
+    return complete;
 }
 
 void TableHeap::DeleteTable(page_id_t page_id) {
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    if (page == nullptr) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+    if (!guard) {
         return;
     }
-    if (page->GetNextPageId() != INVALID_PAGE_ID) {
-        DeleteTable(page->GetNextPageId());
+    page_id_t next_page_id = guard.As<TablePage>()->GetNextPageId();
+    // a page can only be deleted once nobody holds a pin on it
+    guard.Drop();
+    if (next_page_id != INVALID_PAGE_ID) {
+        DeleteTable(next_page_id);
     }
     buffer_pool_manager_->DeletePage(page_id);
 }
@@ -181,26 +383,26 @@ void TableHeap::DeleteTable(page_id_t page_id) {
 /**
  * TODO: test
  */
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
+    BufferPoolStatsScope stats_scope(buffer_pool_counters_);
     RowId first_row_id;
-    if (first_page_id_ == INVALID_PAGE_ID) {
-        return TableIterator();
-    }
     // create a begin ptr
-    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+    page_id_t page_id = first_page_id_;
     // traverse
-    while (page != nullptr && page->GetFirstTupleRid(&first_row_id) == false) {
-        buffer_pool_manager_->UnpinPage(first_page_id_, false);
-        page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page->GetNextPageId()));
+    while (page_id != INVALID_PAGE_ID) {
+        ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id, strategy);
+        if (!guard) {
+            break;
+        }
+        auto page = guard.As<TablePage>();
+        if (page->GetFirstTupleRid(&first_row_id)) {
+            //found
+            return TableIterator(*this, first_row_id, strategy);
+        }
+        page_id = page->GetNextPageId();
     }
     //not found
-    if (page == nullptr) {
-        return TableIterator();
-    } else {  //found
-        auto ret = TableIterator(*this, first_row_id);
-        buffer_pool_manager_->UnpinPage(first_page_id_, false);
-        return ret;
-    }
+    return TableIterator();
 }
 
 /**
@@ -15,7 +15,8 @@ TableIterator::TableIterator(const TableHeap &table_heap, const Row &row) {
     table_heap_ = const_cast<TableHeap *>(&table_heap);
 }
 
-TableIterator::TableIterator(const TableHeap &table_heap, const RowId &row_id) {
+TableIterator::TableIterator(const TableHeap &table_heap, const RowId &row_id, BufferAccessStrategy *strategy)
+        : strategy_(strategy) {
     table_page_id_ = row_id.GetPageId();
     ASSERT(table_page_id_ != INVALID_PAGE_ID, "table_page_ is INVALID_PAGE_ID");
     slot_id_ = row_id.GetSlotNum();
@@ -27,6 +28,10 @@ TableIterator::TableIterator(const TableIterator &other) {
     table_page_id_ = other.table_page_id_;
     slot_id_ = other.slot_id_;
     table_heap_ = other.table_heap_;
+    strategy_ = other.strategy_;
+    read_ahead_tail_ = other.read_ahead_tail_;
+    read_ahead_pages_ = other.read_ahead_pages_;
+    read_ahead_depth_ = other.read_ahead_depth_;
 }
 
 TableIterator::TableIterator() {
@@ -50,12 +55,10 @@ const Row &TableIterator::operator*() {
         // throw exception shows that the iterator is invalid
         throw std::out_of_range("iterator is invalid");
     }
+    BufferPoolStatsScope stats_scope(table_heap_->buffer_pool_counters_);
     Row *row = new Row(RowId(table_page_id_, slot_id_));
-    auto *table_page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(table_page_id_));
-    // if you need multiple threads, need to add lock here
-    table_page->GetTuple(row, table_heap_->schema_, nullptr, table_heap_->lock_manager_);
-    // TODO: not sure if need to unpin page here
-    table_heap_->buffer_pool_manager_->UnpinPage(table_page_id_, false);
+    ReadPageGuard guard = table_heap_->buffer_pool_manager_->FetchPageRead(table_page_id_, strategy_);
+    guard.As<TablePage>()->GetTuple(row, table_heap_->schema_, nullptr, table_heap_->lock_manager_);
     return *row;
 }
 
@@ -64,11 +67,10 @@ Row *TableIterator::operator->() {
         // throw exception shows that the iterator is invalid
         throw std::out_of_range("iterator is invalid");
     }
+    BufferPoolStatsScope stats_scope(table_heap_->buffer_pool_counters_);
     Row *row = new Row(RowId(table_page_id_, slot_id_));
-    auto *table_page = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(table_page_id_));
-    table_page->GetTuple(row, table_heap_->schema_, nullptr, table_heap_->lock_manager_);
-    // TODO: not sure if need to unpin page here
-    table_heap_->buffer_pool_manager_->UnpinPage(table_page_id_, false);
+    ReadPageGuard guard = table_heap_->buffer_pool_manager_->FetchPageRead(table_page_id_, strategy_);
+    guard.As<TablePage>()->GetTuple(row, table_heap_->schema_, nullptr, table_heap_->lock_manager_);
     return row;
 }
 
@@ -80,27 +82,9 @@ TableIterator &TableIterator::operator++() {
         // throw exception shows that the iterator is invalid
         throw std::out_of_range("iterator is invalid");
     }
-    auto table_page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(table_page_id_));
-    RowId row_id(table_page_->GetPageId(), slot_id_);
-    RowId *next_row_id = new RowId();
-    if (table_page_->GetNextTupleRid(row_id, next_row_id)) {
-        table_page_id_ = next_row_id->GetPageId();
-        slot_id_ = next_row_id->GetSlotNum();
-    } else {
+    BufferPoolStatsScope stats_scope(table_heap_->buffer_pool_counters_);
+    if (!MoveToNextTuple()) {
         table_page_id_ = INVALID_PAGE_ID;
-        slot_id_ = INVALID_LSN;
-        while ((table_page_id_ = table_page_->GetNextPageId()) != INVALID_PAGE_ID) {
-            table_page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(table_page_id_));
-            if (table_page_->GetFirstTupleRid(next_row_id)) {
-                slot_id_ = next_row_id->GetSlotNum();
-                table_heap_->buffer_pool_manager_->UnpinPage(table_page_id_, false);
-                break;
-            }
-            table_heap_->buffer_pool_manager_->UnpinPage(table_page_id_, false);
-        }
-        if(slot_id_ == INVALID_LSN) {
-            table_page_id_ = INVALID_PAGE_ID;
-        }
     }
     return *this;
 }
@@ -112,27 +96,78 @@ TableIterator TableIterator::operator++(int) {
         // throw exception shows that the iterator is invalid
         throw std::out_of_range("iterator is invalid");
     }
-    auto table_page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(table_page_id_));
-    RowId row_id(table_page_->GetPageId(), slot_id_);
-    RowId *next_row_id = new RowId();
-    if (table_page_->GetNextTupleRid(row_id, next_row_id)) {
-        table_page_id_ = next_row_id->GetPageId();
-        slot_id_ = next_row_id->GetSlotNum();
-    } else {
-        table_page_id_ = INVALID_PAGE_ID;
+    BufferPoolStatsScope stats_scope(table_heap_->buffer_pool_counters_);
+    if (!MoveToNextTuple()) {
+        *this = TableIterator();
+    }
+    return ret;
+}
+
+bool TableIterator::MoveToNextTuple() {
+    BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+    RowId next_row_id;
+    {
+        ReadPageGuard guard = buffer_pool_manager->FetchPageRead(table_page_id_, strategy_);
+        auto table_page = guard.As<TablePage>();
+        if (table_page->GetNextTupleRid(RowId(table_page_id_, slot_id_), &next_row_id)) {
+            slot_id_ = next_row_id.GetSlotNum();
+            return true;
+        }
+        table_page_id_ = table_page->GetNextPageId();
+        StepReadAhead();
         slot_id_ = INVALID_LSN;
-        while ((table_page_id_ = table_page_->GetNextPageId()) != INVALID_PAGE_ID) {
-            table_page_ = reinterpret_cast<TablePage *>(table_heap_->buffer_pool_manager_->FetchPage(table_page_id_));
-            if (table_page_->GetFirstTupleRid(next_row_id)) {
-                slot_id_ = next_row_id->GetSlotNum();
-                table_heap_->buffer_pool_manager_->UnpinPage(table_page_id_, false);
+    }
+    while (table_page_id_ != INVALID_PAGE_ID) {
+        page_id_t next_page_id;
+        {
+            ReadPageGuard guard = buffer_pool_manager->FetchPageRead(table_page_id_, strategy_);
+            auto table_page = guard.As<TablePage>();
+            if (table_page->GetFirstTupleRid(&next_row_id)) {
+                slot_id_ = next_row_id.GetSlotNum();
                 break;
             }
-            table_heap_->buffer_pool_manager_->UnpinPage(table_page_id_, false);
+            next_page_id = table_page->GetNextPageId();
         }
-        if(slot_id_ == INVALID_LSN) {
-            *this = TableIterator();
+        table_page_id_ = next_page_id;
+        StepReadAhead();
+    }
+    if (slot_id_ == INVALID_LSN) {
+        return false;
+    }
+    // the page guard is gone, the read-ahead can fetch the current page again
+    ReadAhead();
+    return true;
+}
+
+void TableIterator::StepReadAhead() {
+    if (read_ahead_pages_ > 0) {
+        read_ahead_pages_--;
+    }
+}
+
+void TableIterator::ReadAhead() {
+    if (read_ahead_depth_ == 0 || table_page_id_ == INVALID_PAGE_ID) {
+        return;
+    }
+    BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+    if (read_ahead_pages_ == 0) {
+        read_ahead_tail_ = table_page_id_;
+    }
+    // the next page id is only known once the tail is in memory, never block the scan on it
+    while (read_ahead_pages_ < read_ahead_depth_ && read_ahead_tail_ != INVALID_PAGE_ID &&
+           !buffer_pool_manager->IsPageLoading(read_ahead_tail_)) {
+        page_id_t next_page_id;
+        {
+            ReadPageGuard guard = buffer_pool_manager->FetchPageRead(read_ahead_tail_, strategy_);
+            if (!guard) {
+                return;
+            }
+            next_page_id = guard.As<TablePage>()->GetNextPageId();
+        }
+        read_ahead_tail_ = next_page_id;
+        if (next_page_id != INVALID_PAGE_ID) {
+            buffer_pool_manager->PrefetchPage(next_page_id, strategy_);
+            read_ahead_pages_++;
         }
     }
-    return ret;
 }
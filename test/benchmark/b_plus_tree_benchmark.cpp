@@ -0,0 +1,312 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/b_plus_tree.h"
+#include "index/b_plus_tree_index.h"
+#include "storage/table_heap.h"
+
+static const int kKeys = 100000;
+
+struct KeyShape {
+  const char *name_;
+  std::vector<Column *> columns_;
+  size_t key_size_;
+};
+
+/**
+ * The key shapes of the B+ tree tests: the single int column of b_plus_tree_test and the int + char(64) key of
+ * b_plus_tree_index_test.
+ */
+static std::vector<KeyShape> MakeKeyShapes() {
+  return {{"int", {new Column("int", TypeId::kTypeInt, 0, false, false)}, 16},
+          {"int+char(64)",
+           {new Column("id", TypeId::kTypeInt, 0, false, false),
+            new Column("name", TypeId::kTypeChar, 64, 1, true, false)},
+           128}};
+}
+
+static const char *EncodingName(KeyEncoding encoding) {
+  switch (encoding) {
+    case KeyEncoding::kRow:
+      return "row";
+    case KeyEncoding::kMemcomparable:
+      return "memcomparable";
+    default:
+      return "int32";
+  }
+}
+
+static Row MakeKey(const KeyShape &shape, int i, std::vector<char> &name) {
+  std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+  if (shape.columns_.size() > 1) {
+    // a shared prefix, so comparisons have to look past the first bytes of the name
+    snprintf(name.data(), name.size(), "customer-%08d", i);
+    fields.emplace_back(TypeId::kTypeChar, name.data(), strlen(name.data()), true);
+  }
+  return Row(fields);
+}
+
+/**
+ * Insert kKeys keys in random order, then look every one of them up.
+ * @return inserts per second and lookups per second
+ */
+static std::pair<double, double> RunInsertLookup(const KeyShape &shape, KeyEncoding encoding) {
+  const std::string db_name = "b_plus_tree_benchmark.db";
+  remove(("./databases/" + db_name).c_str());
+  double inserts_per_second;
+  double lookups_per_second;
+  {
+    DBStorageEngine engine(db_name);
+    Schema key_schema(shape.columns_, false);
+    KeyManager key_manager(&key_schema, encoding == KeyEncoding::kInt32 ? sizeof(int32_t) : shape.key_size_, encoding);
+    BPlusTree tree(0, engine.bpm_, key_manager);
+    std::vector<int> order(kKeys);
+    for (int i = 0; i < kKeys; i++) {
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(0));
+    std::vector<GenericKey *> keys;
+    std::vector<char> name(32);
+    for (int i : order) {
+      keys.push_back(key_manager.InitKey());
+      key_manager.SerializeFromKey(keys.back(), MakeKey(shape, i, name), &key_schema);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kKeys; i++) {
+      tree.Insert(keys[i], RowId(order[i]));
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    inserts_per_second = kKeys / elapsed.count();
+    std::shuffle(keys.begin(), keys.end(), std::mt19937(1));
+    std::vector<RowId> result;
+    start = std::chrono::steady_clock::now();
+    for (auto key : keys) {
+      result.clear();
+      tree.GetValue(key, result);
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    lookups_per_second = kKeys / elapsed.count();
+    EXPECT_EQ(1, result.size());
+    for (auto key : keys) {
+      free(key);
+    }
+  }
+  remove(("./databases/" + db_name).c_str());
+  return {inserts_per_second, lookups_per_second};
+}
+
+TEST(BPlusTreeBenchmark, KeyEncoding) {
+  auto shapes = MakeKeyShapes();
+  for (auto &shape : shapes) {
+    for (auto encoding : {KeyEncoding::kRow, KeyEncoding::kMemcomparable, KeyEncoding::kInt32}) {
+      // only a single int column can be an int32 key
+      if (encoding == KeyEncoding::kInt32 && shape.columns_.size() > 1) {
+        continue;
+      }
+      auto throughput = RunInsertLookup(shape, encoding);
+      printf("[%-12s] %-13s: %10.0f inserts/s %10.0f lookups/s\n", shape.name_, EncodingName(encoding),
+             throughput.first, throughput.second);
+    }
+    for (auto column : shape.columns_) {
+      delete column;
+    }
+  }
+}
+
+static const int kConcurrentKeys = 200000;
+
+/**
+ * Run op on every key, the keys split round robin between num_threads threads.
+ * @return operations per second
+ */
+template <typename Op>
+static double RunConcurrently(const std::vector<GenericKey *> &keys, int num_threads, Op op) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&keys, num_threads, t, &op] {
+      for (size_t i = t; i < keys.size(); i += num_threads) {
+        op(keys[i]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return keys.size() / elapsed.count();
+}
+
+/**
+ * Insert, look up and remove int32 keys from 1 up to hardware concurrency threads. The tree sits on a sharded buffer
+ * pool, so the pool's latch does not hide how the tree's latches scale.
+ */
+TEST(BPlusTreeBenchmark, ConcurrentInsertLookupRemove) {
+  const std::string db_name = "b_plus_tree_concurrent_benchmark.db";
+  Column column("int", TypeId::kTypeInt, 0, false, false);
+  Schema key_schema({&column}, false);
+  KeyManager key_manager(&key_schema, sizeof(int32_t), KeyEncoding::kInt32);
+  std::vector<GenericKey *> keys;
+  for (int i = 0; i < kConcurrentKeys; i++) {
+    keys.push_back(key_manager.InitKey());
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    key_manager.SerializeFromKey(keys.back(), Row(fields), &key_schema);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  int max_threads = std::max(4u, std::thread::hardware_concurrency());
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    remove(db_name.c_str());
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(16, 8192, disk_manager);
+    // the catalog meta page, then the index roots page the tree keeps its root in
+    page_id_t page_id;
+    for (page_id_t expected : {CATALOG_META_PAGE_ID, INDEX_ROOTS_PAGE_ID}) {
+      ASSERT_NE(nullptr, bpm->NewPage(page_id));
+      ASSERT_EQ(expected, page_id);
+      bpm->UnpinPage(page_id, true);
+    }
+    {
+      BPlusTree tree(0, bpm, key_manager);
+      double inserts = RunConcurrently(keys, num_threads, [&tree](GenericKey *key) {
+        tree.Insert(key, RowId(KeyManager::GetInt32(key)));
+      });
+      double lookups = RunConcurrently(keys, num_threads, [&tree](GenericKey *key) {
+        std::vector<RowId> result;
+        tree.GetValue(key, result);
+      });
+      double removes = RunConcurrently(keys, num_threads, [&tree](GenericKey *key) { tree.Remove(key); });
+      std::vector<RowId> result;
+      EXPECT_FALSE(tree.GetValue(keys[0], result));
+      printf("%2d threads: %10.0f inserts/s %10.0f lookups/s %10.0f removes/s\n", num_threads, inserts, lookups,
+             removes);
+    }
+    delete bpm;
+    disk_manager->Close();
+    delete disk_manager;
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+  remove(db_name.c_str());
+}
+
+static const int kBuildKeys = 500000;
+
+/**
+ * Build a tree from kBuildKeys keys in random order, once by inserting them one by one and once by sorting them and
+ * bulk loading the tree.
+ */
+TEST(BPlusTreeBenchmark, BulkLoad) {
+  const std::string db_name = "b_plus_tree_bulk_load_benchmark.db";
+  auto shapes = MakeKeyShapes();
+  for (auto &shape : shapes) {
+    Schema key_schema(shape.columns_, false);
+    KeyManager key_manager(&key_schema, shape.key_size_);
+    std::vector<int> order(kBuildKeys);
+    for (int i = 0; i < kBuildKeys; i++) {
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(0));
+    std::vector<Row> rows;
+    std::vector<char> name(32);
+    for (int i : order) {
+      rows.push_back(MakeKey(shape, i, name));
+    }
+    for (bool bulk_load : {false, true}) {
+      remove(("./databases/" + db_name).c_str());
+      {
+        DBStorageEngine engine(db_name);
+        BPlusTree tree(0, engine.bpm_, key_manager);
+        GenericKey *key = key_manager.InitKey();
+        size_t runs = 0;
+        auto start = std::chrono::steady_clock::now();
+        if (bulk_load) {
+          KeySorter sorter(key_manager);
+          for (size_t i = 0; i < rows.size(); i++) {
+            sorter.Add(rows[i], &key_schema, RowId(order[i]));
+          }
+          sorter.Finish();
+          runs = sorter.GetRunCount();
+          tree.BulkLoad(sorter);
+        } else {
+          for (size_t i = 0; i < rows.size(); i++) {
+            key_manager.SerializeFromKey(key, rows[i], &key_schema);
+            tree.Insert(key, RowId(order[i]));
+          }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::vector<RowId> result;
+        key_manager.SerializeFromKey(key, rows[0], &key_schema);
+        EXPECT_TRUE(tree.GetValue(key, result));
+        free(key);
+        printf("[%-12s] %-9s: %10.0f keys/s, %zu sorted runs\n", shape.name_, bulk_load ? "bulk load" : "insert",
+               kBuildKeys / elapsed.count(), runs);
+      }
+    }
+    for (auto column : shape.columns_) {
+      delete column;
+    }
+  }
+  remove(("./databases/" + db_name).c_str());
+}
+
+/**
+ * Build an index on a kBuildKeys row table the way CREATE INDEX does, partitioned scan, sort and bulk load, from 1 up
+ * to hardware concurrency workers.
+ */
+TEST(BPlusTreeBenchmark, ParallelIndexBuild) {
+  const std::string db_name = "b_plus_tree_parallel_build_benchmark.db";
+  remove(("./databases/" + db_name).c_str());
+  {
+    DBStorageEngine engine(db_name);
+    auto shapes = MakeKeyShapes();
+    KeyShape &shape = shapes.back();
+    Schema table_schema(shape.columns_, false);
+    TableHeap *table_heap = TableHeap::Create(engine.bpm_, &table_schema, nullptr, nullptr, nullptr);
+    std::vector<int> order(kBuildKeys);
+    for (int i = 0; i < kBuildKeys; i++) {
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(0));
+    std::vector<char> name(32);
+    for (int i : order) {
+      Row row = MakeKey(shape, i, name);
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    }
+    auto *key_schema = Schema::ShallowCopySchema(&table_schema, {0, 1});
+    int max_workers = std::max(4u, std::thread::hardware_concurrency());
+    index_id_t index_id = 0;
+    for (int num_workers = 1; num_workers <= max_workers; num_workers *= 2) {
+      BPlusTreeIndex index(index_id++, key_schema, shape.key_size_, engine.bpm_);
+      auto start = std::chrono::steady_clock::now();
+      index.BulkLoad(
+          num_workers,
+          [&](const Index::EntryConsumer &add) {
+            return table_heap->PartitionedScan(num_workers, [&](size_t worker, Row &row) {
+              Row key(row.GetRowId());
+              row.GetKeyFromRow(&table_schema, key_schema, key);
+              add(worker, key, row.GetRowId());
+            });
+          },
+          nullptr);
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      printf("%2d workers: %10.0f rows/s\n", num_workers, kBuildKeys / elapsed.count());
+      index.Destroy();
+    }
+    delete key_schema;
+    delete table_heap;
+    for (auto &key_shape : shapes) {
+      for (auto column : key_shape.columns_) {
+        delete column;
+      }
+    }
+  }
+  remove(("./databases/" + db_name).c_str());
+}
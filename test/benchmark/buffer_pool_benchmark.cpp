@@ -0,0 +1,62 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+static const int kWorkingSetPages = 4096;
+static const int kOperationsPerThread = 200000;
+
+/**
+ * Each thread fetches and unpins random pages of a working set that fits in the pool.
+ */
+static double RunFetchUnpin(BufferPoolManager *bpm, int num_threads) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([bpm, t] {
+      std::mt19937 rng(t);
+      std::uniform_int_distribution<page_id_t> dist(0, kWorkingSetPages - 1);
+      for (int i = 0; i < kOperationsPerThread; i++) {
+        page_id_t page_id = dist(rng);
+        Page *page = bpm->FetchPage(page_id);
+        if (page != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+TEST(BufferPoolBenchmark, ConcurrentFetchUnpin) {
+  const std::string db_name = "bpm_benchmark.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  int max_threads = std::max(4u, std::thread::hardware_concurrency());
+  for (size_t num_instances : {1, 4, 16}) {
+    auto *bpm = new ParallelBufferPoolManager(num_instances, kWorkingSetPages * 2, disk_manager);
+    for (int i = 0; i < kWorkingSetPages; i++) {
+      page_id_t page_id;
+      if (bpm->NewPage(page_id) != nullptr) {
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      double seconds = RunFetchUnpin(bpm, num_threads);
+      printf("[%2zu instances] %2d threads: %10.0f fetch+unpin/s\n", num_instances, num_threads,
+             num_threads * kOperationsPerThread / seconds);
+    }
+    delete bpm;
+  }
+  disk_manager->Close();
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+static const int kEvictions = 200000;
+
+static std::unique_ptr<Replacer> MakeReplacer(ReplacerType type, size_t num_frames) {
+  switch (type) {
+    case ReplacerType::kLRUK:
+      return std::make_unique<LRUKReplacer>(num_frames);
+    case ReplacerType::kClock:
+      return std::make_unique<ClockReplacer>(num_frames);
+    case ReplacerType::kLRU:
+    default:
+      return std::make_unique<LRUReplacer>(num_frames);
+  }
+}
+
+/**
+ * Steady state of a full pool: every eviction reloads the victim frame, and a hot tenth of the frames is referenced
+ * again between evictions.
+ * @return nanoseconds per eviction
+ */
+static double RunEvictions(Replacer *replacer, size_t num_frames) {
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer->Pin(i);
+    replacer->Unpin(i);
+  }
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<frame_id_t> hot(0, static_cast<frame_id_t>(num_frames / 10));
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kEvictions; i++) {
+    frame_id_t frame_id;
+    if (!replacer->Victim(&frame_id)) {
+      return -1;
+    }
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+    frame_id_t hot_frame = hot(rng);
+    replacer->Pin(hot_frame);
+    replacer->Unpin(hot_frame);
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / kEvictions;
+}
+
+TEST(ReplacerBenchmark, EvictionCost) {
+  const std::pair<ReplacerType, const char *> replacers[] = {
+      {ReplacerType::kLRU, "LRU"}, {ReplacerType::kLRUK, "LRU-K"}, {ReplacerType::kClock, "Clock"}};
+  for (size_t num_frames : {1000, 10000, 100000, 1000000}) {
+    for (auto &replacer : replacers) {
+      auto instance = MakeReplacer(replacer.first, num_frames);
+      double ns = RunEvictions(instance.get(), num_frames);
+      ASSERT_GT(ns, 0);
+      printf("[%7zu frames] %-5s: %8.1f ns/eviction\n", num_frames, replacer.second, ns);
+    }
+  }
+}
@@ -1,9 +1,12 @@
 #include "buffer/buffer_pool_manager.h"
 
+#include <chrono>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
 
+#include "buffer/database_buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -78,4 +81,419 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+TEST(BufferPoolManagerTest, AsyncDirtyEvictionTest) {
+  const std::string db_name = "bpm_async_test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 200;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name, DiskIOBackend::kIoUring);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  // every fetch evicts a dirty frame, the write back and the read overlap
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < num_pages; i++) {
+      Page *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      char expected[32];
+      snprintf(expected, sizeof(expected), "page %d", i);
+      ASSERT_STREQ(expected, page->GetData());
+      bpm->UnpinPage(i, true);
+    }
+  }
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, AccessStrategyTest) {
+  const std::string db_name = "bpm_strategy_test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_pages = 256;
+  const int num_hot_pages = 16;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  // mark the hot pages in memory only, they read back as marked for as long as they stay resident
+  for (int i = 0; i < num_hot_pages; i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "hot %d", i);
+    bpm->UnpinPage(i, false);
+  }
+  // a full scan through a ring of 4 frames
+  BufferAccessStrategy strategy(4);
+  for (int i = num_hot_pages; i < num_pages; i++) {
+    Page *page = bpm->FetchPage(i, &strategy);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    ASSERT_STREQ(expected, page->GetData());
+    bpm->UnpinPage(i, false);
+  }
+  for (int i = 0; i < num_hot_pages; i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "hot %d", i);
+    EXPECT_STREQ(expected, page->GetData());
+    bpm->UnpinPage(i, false);
+  }
+  // without a strategy the same scan pushes the hot pages out
+  for (int i = num_hot_pages; i < num_pages; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    bpm->UnpinPage(i, false);
+  }
+  Page *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("page 0", page->GetData());
+  bpm->UnpinPage(0, false);
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "bpm_bgwriter_test.db";
+  const size_t buffer_pool_size = 64;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  // pinned dirty pages are left alone
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  bpm->StartBackgroundWriter(buffer_pool_size, 8, 1);
+  for (int wait_ms = 0; wait_ms < 5000 && bpm->GetWriteStats().background_writes_ < buffer_pool_size - 1; wait_ms++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  bpm->StopBackgroundWriter();
+  EXPECT_EQ(buffer_pool_size - 1, bpm->GetWriteStats().background_writes_);
+  bpm->UnpinPage(0, false);
+  // every other frame is clean now, so replacing them costs no write
+  for (size_t i = 1; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(0, bpm->GetWriteStats().eviction_writes_);
+  for (size_t i = 1; i < buffer_pool_size; i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %zu", i);
+    EXPECT_STREQ(expected, page->GetData());
+    bpm->UnpinPage(i, false);
+  }
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 64;
+  const int num_pages = 256;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  // a resident dirty page is left as it is
+  Page *page = bpm->FetchPage(num_pages - 1);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "changed");
+  bpm->UnpinPage(num_pages - 1, true);
+  bpm->PrefetchPage(num_pages - 1);
+  // the head of the file was evicted long ago, read it back in the background
+  bpm->PrefetchRange(0, 32);
+  for (int i = 0; i < 32; i++) {
+    page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_FALSE(bpm->IsPageLoading(i));
+    bpm->UnpinPage(i, false);
+  }
+  page = bpm->FetchPage(num_pages - 1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("changed", page->GetData());
+  bpm->UnpinPage(num_pages - 1, false);
+  // with every frame pinned a prefetch has nowhere to go and is dropped
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+  }
+  bpm->PrefetchPage(num_pages / 2);
+  EXPECT_FALSE(bpm->IsPageLoading(num_pages / 2));
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, StatsTest) {
+  const std::string db_name = "bpm_stats_test.db";
+  const size_t buffer_pool_size = 4;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  BufferPoolCounters *table_counters = bpm->GetOwnerCounters("table t");
+  page_id_t page_id;
+  // fill the pool with dirty pages while holding every frame
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.new_page_failures_);
+  EXPECT_EQ(buffer_pool_size, stats.pinned_frames_);
+  EXPECT_EQ(buffer_pool_size, stats.pinned_high_water_);
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  {
+    BufferPoolStatsScope scope(table_counters);
+    // resident pages are hits
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(i));
+      bpm->UnpinPage(i, false);
+    }
+    // a page that is not resident pushes a dirty page out
+    ASSERT_NE(nullptr, bpm->NewPage(page_id));
+    bpm->UnpinPage(page_id, false);
+    ASSERT_NE(nullptr, bpm->FetchPage(0));
+    bpm->UnpinPage(0, false);
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size + 1, stats.fetches_);
+  EXPECT_EQ(buffer_pool_size, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.dirty_writes_);
+  EXPECT_EQ(0, stats.pinned_frames_);
+  EXPECT_EQ(buffer_pool_size, stats.pinned_high_water_);
+  // everything inside the scope was charged to the table as well, nothing outside of it was
+  auto owner_stats = bpm->GetOwnerStats();
+  ASSERT_EQ(1, owner_stats.count("table t"));
+  BufferPoolStats table_stats = owner_stats["table t"];
+  EXPECT_EQ(stats.fetches_, table_stats.fetches_);
+  EXPECT_EQ(stats.hits_, table_stats.hits_);
+  EXPECT_EQ(stats.evictions_, table_stats.evictions_);
+  EXPECT_EQ(stats.dirty_writes_, table_stats.dirty_writes_);
+  EXPECT_EQ(0, table_stats.new_page_failures_);
+  EXPECT_DOUBLE_EQ(static_cast<double>(buffer_pool_size) / (buffer_pool_size + 1), table_stats.HitRatio());
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.fetches_);
+  EXPECT_EQ(0, stats.pinned_high_water_);
+  EXPECT_EQ(0, bpm->GetOwnerStats()["table t"].fetches_);
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, WarmUpTest) {
+  const std::string db_name = "bpm_warm_up_test.db";
+  const std::string warm_up_name = "bpm_warm_up_test.warmup";
+  const size_t buffer_pool_size = 8;
+  remove(db_name.c_str());
+  remove(warm_up_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    Page *page = bpm->NewPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  // touch the first half of the file last so that it is what stays resident, page 3 the most recently
+  for (page_id_t i : {7, 6, 5, 4, 2, 1, 0, 3}) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    bpm->UnpinPage(i, false);
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(5));
+  std::vector<page_id_t> hot_pages = bpm->GetHotPages();
+  ASSERT_EQ(buffer_pool_size, hot_pages.size());
+  EXPECT_EQ(5, hot_pages[0]);  // pinned
+  EXPECT_EQ(3, hot_pages[1]);  // most recently unpinned
+  bpm->UnpinPage(5, false);
+  ASSERT_TRUE(bpm->SaveWarmUpList(warm_up_name));
+  delete bpm;
+  // a fresh pool reads the saved pages back without being asked for them
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size, bpm->StartWarmUp(warm_up_name));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "page %d", i);
+    EXPECT_STREQ(expected, page->GetData());
+    bpm->UnpinPage(i, false);
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().hits_);
+  // the list is used up
+  EXPECT_EQ(0, bpm->StartWarmUp(warm_up_name));
+  // a list whose count does not match the page ids it holds is ignored
+  ASSERT_TRUE(bpm->SaveWarmUpList(warm_up_name));
+  FILE *file = fopen(warm_up_name.c_str(), "r+b");
+  ASSERT_NE(nullptr, file);
+  uint32_t count = 0xffffffff;
+  fseek(file, sizeof(uint32_t), SEEK_SET);
+  ASSERT_EQ(1, fwrite(&count, sizeof(count), 1, file));
+  fclose(file);
+  EXPECT_EQ(0, bpm->StartWarmUp(warm_up_name));
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "bpm_resize_test.db";
+  const size_t buffer_pool_size = 8;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  for (auto replacer_type : {ReplacerType::kLRU, ReplacerType::kLRUK, ReplacerType::kClock}) {
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, replacer_type);
+    std::vector<page_id_t> page_ids;
+    page_id_t page_id;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      Page *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      page_ids.push_back(page_id);
+    }
+    EXPECT_EQ(nullptr, bpm->NewPage(page_id));
+    // growing hands out new frames while the old ones stay pinned
+    EXPECT_EQ(3 * buffer_pool_size, bpm->ResizePool(3 * buffer_pool_size));
+    EXPECT_EQ(3 * buffer_pool_size, bpm->GetPoolSize());
+    for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+      Page *page = bpm->NewPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      page_ids.push_back(page_id);
+      bpm->UnpinPage(page_id, true);
+    }
+    // shrinking stops at the last pinned frame
+    EXPECT_EQ(buffer_pool_size, bpm->ResizePool(2));
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      bpm->UnpinPage(page_ids[i], true);
+    }
+    EXPECT_EQ(2, bpm->ResizePool(2));
+    EXPECT_EQ(2, bpm->GetPoolSize());
+    // dirty pages that were pushed out were written back, and the small pool still evicts
+    for (auto id : page_ids) {
+      Page *page = bpm->FetchPage(id);
+      ASSERT_NE(nullptr, page);
+      char expected[32];
+      snprintf(expected, sizeof(expected), "page %d", id);
+      EXPECT_STREQ(expected, page->GetData());
+      bpm->UnpinPage(id, false);
+    }
+    EXPECT_TRUE(bpm->CheckAllUnpinned());
+    EXPECT_EQ(buffer_pool_size, bpm->ResizePool(buffer_pool_size));
+    delete bpm;
+    for (auto id : page_ids) {
+      disk_manager->DeAllocatePage(id);
+    }
+  }
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, SharedPoolTest) {
+  const std::string db_names[] = {"bpm_shared_test_0.db", "bpm_shared_test_1.db"};
+  const size_t buffer_pool_size = 4;
+  auto *pool = new BufferPoolManager(buffer_pool_size, nullptr);
+  DiskManager *disk_managers[2];
+  BufferPoolManager *views[2];
+  for (int i = 0; i < 2; i++) {
+    remove(db_names[i].c_str());
+    disk_managers[i] = new DiskManager(db_names[i]);
+    views[i] = new DatabaseBufferPoolManager(pool, disk_managers[i]);
+  }
+  // both files start at page 0, the pool keeps their pages apart
+  page_id_t page_id[2];
+  for (int i = 0; i < 2; i++) {
+    Page *page = views[i]->NewPage(page_id[i]);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "file %d", i);
+  }
+  EXPECT_EQ(page_id[0], page_id[1]);
+  for (int i = 0; i < 2; i++) {
+    Page *page = views[i]->FetchPage(page_id[i]);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "file %d", i);
+    EXPECT_STREQ(expected, page->GetData());
+    views[i]->UnpinPage(page_id[i], false);
+    views[i]->UnpinPage(page_id[i], true);
+  }
+  EXPECT_TRUE(views[0]->CheckAllUnpinned());
+  // the files compete for the same frames: a run of file 1 pages pushes file 0 out of the pool
+  std::vector<page_id_t> file_1_pages;
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t new_page_id;
+    Page *page = views[1]->NewPage(new_page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "file 1 page %d", new_page_id);
+    file_1_pages.push_back(new_page_id);
+    views[1]->UnpinPage(new_page_id, true);
+  }
+  EXPECT_TRUE(views[0]->GetHotPages().empty());
+  EXPECT_EQ(buffer_pool_size, views[1]->GetHotPages().size());
+  EXPECT_EQ(buffer_pool_size, views[0]->GetPoolSize());
+  Page *page = views[0]->FetchPage(page_id[0]);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("file 0", page->GetData());
+  // a file with a pinned page is only checked on its own
+  EXPECT_FALSE(views[0]->CheckAllUnpinned());
+  EXPECT_TRUE(views[1]->CheckAllUnpinned());
+  views[0]->UnpinPage(page_id[0], false);
+  // detaching writes the file's dirty pages back and leaves the other file's pages in the pool
+  delete views[1];
+  delete disk_managers[1];
+  disk_managers[1] = new DiskManager(db_names[1]);
+  views[1] = new DatabaseBufferPoolManager(pool, disk_managers[1]);
+  for (auto id : file_1_pages) {
+    page = views[1]->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    char expected[32];
+    snprintf(expected, sizeof(expected), "file 1 page %d", id);
+    EXPECT_STREQ(expected, page->GetData());
+    views[1]->UnpinPage(id, false);
+  }
+  for (int i = 0; i < 2; i++) {
+    EXPECT_TRUE(views[i]->CheckAllUnpinned());
+    delete views[i];
+    delete disk_managers[i];
+    remove(db_names[i].c_str());
+  }
+  delete pool;
+}
@@ -0,0 +1,60 @@
+#include "buffer/clock_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(ClockReplacerTest, SampleTest) {
+  ClockReplacer clock_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer. Frame 0 is a valid frame too.
+  for (int i = 0; i <= 5; i++) {
+    clock_replacer.Unpin(i);
+  }
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+  EXPECT_EQ(6, clock_replacer.UnpinSize());
+
+  // Scenario: every frame has its reference bit set, so the first sweep clears them and the hand evicts in order.
+  int value;
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+
+  // Scenario: pin elements in the replacer. 3 is no longer evictable.
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(1, clock_replacer.UnpinSize());
+  EXPECT_EQ(2, clock_replacer.PinSize());
+
+  // Scenario: unpin 4 gives it a fresh reference bit, so 5 goes first and the hand keeps its position.
+  clock_replacer.Unpin(4);
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(clock_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+  EXPECT_EQ(1, clock_replacer.Size());
+}
+
+TEST(ClockReplacerTest, LargePoolTest) {
+  const int num_frames = 1000;
+  ClockReplacer clock_replacer(num_frames);
+  for (int i = 0; i < num_frames; i++) {
+    clock_replacer.Unpin(i);
+  }
+  // Only every 100th frame stays evictable, the hand has to skip over whole words of pinned frames.
+  for (int i = 0; i < num_frames; i++) {
+    if (i % 100 != 99) {
+      clock_replacer.Pin(i);
+    }
+  }
+  EXPECT_EQ(10, clock_replacer.UnpinSize());
+  int value;
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(clock_replacer.Victim(&value));
+    EXPECT_EQ(i * 100 + 99, value);
+  }
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+  EXPECT_EQ(num_frames - 10, clock_replacer.Size());
+}
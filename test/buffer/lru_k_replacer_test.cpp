@@ -0,0 +1,103 @@
+#include "buffer/lru_k_replacer.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(10, 2, 0);
+
+  // Scenario: frame 1 is accessed twice, frames 2-6 once.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  for (int i = 2; i <= 6; i++) {
+    lru_k_replacer.Pin(i);
+  }
+  lru_k_replacer.Pin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+  EXPECT_EQ(6, lru_k_replacer.PinSize());
+  EXPECT_EQ(0, lru_k_replacer.UnpinSize());
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.UnpinSize());
+  EXPECT_EQ(0, lru_k_replacer.PinSize());
+
+  // Scenario: frames with a single access have infinite k-distance and go first, oldest first.
+  int value;
+  for (int i = 2; i <= 4; i++) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(i, value);
+  }
+  // Scenario: a second access to frame 5 moves it behind frame 6 but ahead of frame 1.
+  lru_k_replacer.Pin(5);
+  lru_k_replacer.Unpin(5);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  // Scenario: pinned frames are never chosen.
+  lru_k_replacer.Pin(5);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  lru_k_replacer.Unpin(5);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(10, 2, 3);
+
+  // Scenario: frame 1 is pinned three times in a row, which is one correlated reference.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  // Scenario: frame 2 is referenced twice, far enough apart to count as two accesses.
+  lru_k_replacer.Pin(2);
+  for (int i = 3; i <= 7; i++) {
+    lru_k_replacer.Pin(i);
+  }
+  lru_k_replacer.Pin(2);
+  for (int i = 1; i <= 7; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+
+  int value;
+  for (int expected : {1, 3, 4, 5, 6, 7, 2}) {
+    ASSERT_TRUE(lru_k_replacer.Victim(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, RemoveTest) {
+  LRUKReplacer lru_k_replacer(10, 2, 0);
+
+  // Scenario: frames 1 and 3 are both accessed twice, frame 1 last.
+  for (int i : {3, 3, 1, 1}) {
+    lru_k_replacer.Pin(i);
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  // Scenario: the page of frame 1 is deleted, the frame forgets it was ever used.
+  lru_k_replacer.Remove(1);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  EXPECT_EQ(0, lru_k_replacer.PinSize());
+  // Scenario: removing a frame the replacer does not track changes nothing.
+  lru_k_replacer.Remove(5);
+  EXPECT_EQ(1, lru_k_replacer.Size());
+  EXPECT_EQ(0, lru_k_replacer.PinSize());
+  // Scenario: the next page in frame 1 is accessed once, it has less than k accesses and goes first.
+  lru_k_replacer.Pin(1);
+  EXPECT_EQ(1, lru_k_replacer.PinSize());
+  lru_k_replacer.Unpin(1);
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  // Scenario: a pinned frame that is removed is no longer counted as pinned.
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Remove(2);
+  EXPECT_EQ(0, lru_k_replacer.PinSize());
+  EXPECT_EQ(0, lru_k_replacer.Size());
+}
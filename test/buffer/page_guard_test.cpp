@@ -0,0 +1,59 @@
+#include "buffer/page_guard.h"
+
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "page_guard_test.db";
+  const size_t buffer_pool_size = 4;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  {
+    WritePageGuard guard = bpm->NewPageGuarded(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    snprintf(guard.AsMut<Page>()->GetData(), PAGE_SIZE, "guarded");
+    EXPECT_EQ(1, guard.As<Page>()->GetPinCount());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  // moving a guard hands its pin over instead of taking another one
+  ReadPageGuard moved;
+  {
+    ReadPageGuard guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(1, guard.As<Page>()->GetPinCount());
+    moved = std::move(guard);
+    EXPECT_FALSE(guard.IsValid());
+  }
+  ASSERT_TRUE(moved.IsValid());
+  EXPECT_EQ(1, moved.As<Page>()->GetPinCount());
+  EXPECT_STREQ("guarded", moved.As<Page>()->GetData());
+  // several readers can share a page
+  {
+    ReadPageGuard other = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, other.As<Page>()->GetPinCount());
+  }
+  moved.Drop();
+  EXPECT_EQ(INVALID_PAGE_ID, moved.PageId());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  // the page was written through a guard, so it survives being evicted by a run of new pages
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    page_id_t new_page_id;
+    ASSERT_TRUE(bpm->NewPageGuarded(new_page_id).IsValid());
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  {
+    BasicPageGuard guard = bpm->FetchPageBasic(page_id);
+    ASSERT_TRUE(guard.IsValid());
+    EXPECT_STREQ("guarded", guard.As<Page>()->GetData());
+  }
+  // a failed fetch gives an empty guard
+  EXPECT_FALSE(bpm->FetchPageRead(INVALID_PAGE_ID).IsValid());
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -0,0 +1,118 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/database_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+TEST(ParallelBufferPoolManagerTest, ConcurrentNewFetchTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 64;
+  const int num_threads = 4;
+  const int pages_per_thread = 100;
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(num_instances, bpm->GetNumInstances());
+
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+        page_ids[t].push_back(page_id);
+        bpm->UnpinPage(page_id, true);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  // every thread re-reads the pages of all threads, forcing evictions across instances
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int k = 0; k < num_threads; k++) {
+        for (auto page_id : page_ids[(t + k) % num_threads]) {
+          Page *page = bpm->FetchPage(page_id);
+          ASSERT_NE(nullptr, page);
+          EXPECT_EQ(page_id, page->GetPageId());
+          EXPECT_EQ(std::to_string(page_id), page->GetData());
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  EXPECT_FALSE(bpm->IsPageFree(page_ids[0][0]));
+  EXPECT_TRUE(bpm->DeletePage(page_ids[0][0]));
+  EXPECT_TRUE(bpm->IsPageFree(page_ids[0][0]));
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, SharedPoolTest) {
+  const int num_files = 2;
+  const std::string db_names[num_files] = {"parallel_bpm_shared_test_0.db", "parallel_bpm_shared_test_1.db"};
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 32;
+  const int pages_per_file = 100;
+  auto *pool = new ParallelBufferPoolManager(num_instances, buffer_pool_size, nullptr);
+  DiskManager *disk_managers[num_files];
+  BufferPoolManager *views[num_files];
+  for (int i = 0; i < num_files; i++) {
+    remove(db_names[i].c_str());
+    disk_managers[i] = new DiskManager(db_names[i]);
+    views[i] = new DatabaseBufferPoolManager(pool, disk_managers[i]);
+  }
+  // every database works on its own file from its own thread, the pages of both go through the shards
+  std::vector<std::vector<page_id_t>> page_ids(num_files);
+  std::vector<std::thread> threads;
+  for (int f = 0; f < num_files; f++) {
+    threads.emplace_back([&, f] {
+      for (int i = 0; i < pages_per_file; i++) {
+        page_id_t page_id;
+        Page *page = views[f]->NewPage(page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), PAGE_SIZE, "file %d page %d", f, page_id);
+        page_ids[f].push_back(page_id);
+        views[f]->UnpinPage(page_id, true);
+      }
+      for (auto page_id : page_ids[f]) {
+        Page *page = views[f]->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        char expected[32];
+        snprintf(expected, sizeof(expected), "file %d page %d", f, page_id);
+        EXPECT_STREQ(expected, page->GetData());
+        views[f]->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  // both files number their pages from the same start, the pool keeps them apart
+  EXPECT_EQ(page_ids[0], page_ids[1]);
+  EXPECT_EQ(buffer_pool_size, views[0]->GetPoolSize());
+  EXPECT_EQ(buffer_pool_size, views[0]->GetHotPages().size() + views[1]->GetHotPages().size());
+  for (int i = 0; i < num_files; i++) {
+    EXPECT_TRUE(views[i]->CheckAllUnpinned());
+    delete views[i];
+    delete disk_managers[i];
+    remove(db_names[i].c_str());
+  }
+  delete pool;
+}
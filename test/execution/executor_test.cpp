@@ -5,6 +5,7 @@
 #include "executor/plans/index_scan_plan.h"
 #include "executor/plans/insert_plan.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "executor/plans/truncate_plan.h"
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "executor_test_util.h"  // NOLINT
@@ -159,3 +160,47 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
         ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
     }
 }
+
+// TRUNCATE TABLE table-1;
+// INSERT INTO table-1 VALUES (1001, "aaa", 2.33);
+TEST_F(ExecutorTest, SimpleTruncateTest) {
+    TableInfo *table_info;
+    GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+    const Schema *schema = table_info->GetSchema();
+    IndexInfo *index_info = nullptr;
+    std::vector<std::string> index_keys{"id"};
+    ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-1", index_keys, GetTxn(),
+                                                                          index_info, "bptree"));
+
+    // every row is counted, none is left in the table or the index
+    std::vector<Row> result_set{};
+    auto truncate_plan = std::make_shared<TruncatePlanNode>(nullptr, "table-1");
+    GetExecutionEngine()->ExecutePlan(truncate_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(1000, result_set.size());
+    result_set.clear();
+    auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+    auto const2000 = MakeConstantValueExpression(Field(kTypeInt, 2000));
+    auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(),
+                                                  MakeComparisonExpression(col_a, const2000, "<"));
+    GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_TRUE(result_set.empty());
+    std::vector<Field> key_fields{Field(kTypeInt, 50)};
+    std::vector<RowId> rids{};
+    index_info->GetIndex()->ScanKey(Row(key_fields), rids, GetTxn());
+    ASSERT_TRUE(rids.empty());
+
+    // the emptied table and index take new rows
+    auto const1 = MakeConstantValueExpression(Field(kTypeInt, 1001));
+    auto const2 = MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>("aaa"), 3, false));
+    auto const3 = MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(2.33)));
+    std::vector<std::vector<AbstractExpressionRef>> raw_values{{const1, const2, const3}};
+    auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+    auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+    GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+    result_set.clear();
+    GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    ASSERT_EQ(1, result_set.size());
+    std::vector<Field> new_key_fields{Field(kTypeInt, 1001)};
+    index_info->GetIndex()->ScanKey(Row(new_key_fields), rids, GetTxn());
+    ASSERT_EQ(1, rids.size());
+}
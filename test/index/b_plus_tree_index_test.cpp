@@ -1,6 +1,8 @@
 #include "index/b_plus_tree_index.h"
 
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "common/instance.h"
 #include "gtest/gtest.h"
@@ -29,6 +31,69 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
     remove(("./databases/" + db_name).c_str());
 }
 
+TEST(BPlusTreeTests, MemcomparableKeyTest) {
+    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                     new Column("name", TypeId::kTypeChar, 8, 1, true, false),
+                                     new Column("account", TypeId::kTypeFloat, 2, true, false)};
+    auto *key_schema = new Schema(columns);
+    KeyManager memcomparable(key_schema, 32, KeyEncoding::kMemcomparable);
+    KeyManager row(key_schema, 64, KeyEncoding::kRow);
+    std::vector<int32_t> ints{INT32_MIN, -70000, -1, 0, 1, 255, 256, 70000, INT32_MAX};
+    std::vector<std::string> names{"", "a", std::string("a\0", 2), "ab", "b", "zzzzzzzz"};
+    std::vector<float> floats{-1e30f, -2.5f, -0.0f, 0.0f, 1e-30f, 2.5f, 1e30f};
+    std::vector<Row> keys;
+    for (auto i : ints) {
+        for (auto &name : names) {
+            for (auto f : floats) {
+                std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                                          Field(TypeId::kTypeChar, const_cast<char *>(name.data()), name.size(), true),
+                                          Field(TypeId::kTypeFloat, f)};
+                keys.emplace_back(fields);
+            }
+        }
+    }
+    // a null column sorts before every value
+    std::vector<Field> null_fields{Field(TypeId::kTypeInt), Field(TypeId::kTypeChar, const_cast<char *>("a"), 1, true),
+                                   Field(TypeId::kTypeFloat, 0.0f)};
+    Row null_key(null_fields);
+    GenericKey *null_encoded = memcomparable.InitKey();
+    memcomparable.SerializeFromKey(null_encoded, null_key, key_schema);
+    // memcmp of two encoded keys orders them like comparing the fields one by one
+    std::vector<GenericKey *> encoded;
+    std::vector<GenericKey *> serialized;
+    for (auto &key : keys) {
+        encoded.push_back(memcomparable.InitKey());
+        memcomparable.SerializeFromKey(encoded.back(), key, key_schema);
+        serialized.push_back(row.InitKey());
+        row.SerializeFromKey(serialized.back(), key, key_schema);
+        EXPECT_LT(memcomparable.CompareKeys(null_encoded, encoded.back()), 0);
+    }
+    auto sign = [](int x) { return (x > 0) - (x < 0); };
+    for (size_t i = 0; i < keys.size(); i++) {
+        for (size_t j = 0; j < keys.size(); j += 7) {
+            ASSERT_EQ(sign(row.CompareKeys(serialized[i], serialized[j])),
+                      sign(memcomparable.CompareKeys(encoded[i], encoded[j])));
+        }
+        // and decodes back to the same fields
+        Row decoded;
+        memcomparable.DeserializeToKey(encoded[i], decoded, key_schema);
+        for (uint32_t k = 0; k < key_schema->GetColumnCount(); k++) {
+            ASSERT_EQ(CmpBool::kTrue, decoded.GetField(k)->CompareEquals(*keys[i].GetField(k)));
+        }
+    }
+    Row decoded_null;
+    memcomparable.DeserializeToKey(null_encoded, decoded_null, key_schema);
+    EXPECT_TRUE(decoded_null.GetField(0)->IsNull());
+    for (auto key : encoded) {
+        free(key);
+    }
+    for (auto key : serialized) {
+        free(key);
+    }
+    free(null_encoded);
+    delete key_schema;
+}
+
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     //  using INDEX_KEY_TYPE = GenericKey<32>;
     //  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
@@ -68,4 +133,56 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     }
     delete index;
     remove(("./databases/" + db_name).c_str());
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, BPlusTreeIndexBulkLoadTest) {
+    DBStorageEngine engine(db_name);
+    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                     new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+    std::vector<uint32_t> index_key_map{0, 1};
+    const TableSchema table_schema(columns);
+    auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+    auto *index = new BPlusTreeIndex(0, index_schema, 128, engine.bpm_);
+    const int n = 10000;
+    const size_t num_workers = 4;
+    // every worker adds its own slice of the keys from its own thread, largest key first
+    ASSERT_EQ(DB_SUCCESS, index->BulkLoad(num_workers, [&](const Index::EntryConsumer &add) {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_workers; t++) {
+            threads.emplace_back([&, t] {
+                for (int i = n - 1 - t; i >= 0; i -= num_workers) {
+                    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                                              Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+                    add(t, Row(fields), RowId(1000, i));
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        return true;
+    }, nullptr));
+    for (int i = 0; i < n; i++) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                                  Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+        std::vector<RowId> ret;
+        ASSERT_EQ(DB_SUCCESS, index->ScanKey(Row(fields), ret, nullptr));
+        ASSERT_EQ(RowId(1000, i).Get(), ret[0].Get());
+    }
+    uint32_t i = 0;
+    for (IndexIterator iter = index->GetBeginIterator(); iter != index->GetEndIterator(); ++iter, i++) {
+        ASSERT_EQ(i, (*iter).second.GetSlotNum());
+    }
+    ASSERT_EQ(n, i);
+    // a producer that could not pass every entry leaves the index empty
+    auto *partial = new BPlusTreeIndex(1, index_schema, 128, engine.bpm_);
+    ASSERT_EQ(DB_FAILED, partial->BulkLoad(num_workers, [&](const Index::EntryConsumer &add) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, 0),
+                                  Field(TypeId::kTypeChar, const_cast<char *>("minisql"), 7, true)};
+        add(0, Row(fields), RowId(1000, 0));
+        return false;
+    }, nullptr));
+    ASSERT_TRUE(partial->GetBeginIterator() == partial->GetEndIterator());
+    delete partial;
+    delete index;
+    remove(("./databases/" + db_name).c_str());
+}
@@ -9,6 +9,8 @@
 #include "utils/utils.h"
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include <vector>
 
 static const std::string db_name = "bp_tree_insert_test.db";
@@ -471,3 +473,248 @@ TEST(BPlusTreeTests, LeafRedistributionToLeaf) {
     tree.LdsPrintTree();
     remove(("./databases/" + db_name).c_str());
 }
+
+TEST(BPlusTreeTests, Int32KeyTest) {
+    // Init engine
+    DBStorageEngine engine(db_name);
+    std::vector<Column *> columns = {
+            new Column("int", TypeId::kTypeInt, 0, false, false),
+    };
+    Schema *table_schema = new Schema(columns);
+    ASSERT_EQ(KeyEncoding::kInt32, KeyManager::ChooseEncoding(table_schema, {0}));
+    KeyManager KP(table_schema, sizeof(int32_t), KeyEncoding::kInt32);
+    KeyManager memcomparable_KP(table_schema, 16);
+    // tiny pages exercise the searches on few keys, default pages hold twice the keys of a 16 byte key
+    BPlusTree small_tree(0, engine.bpm_, KP, 4, 4);
+    BPlusTree tree(1, engine.bpm_, KP);
+    BPlusTree memcomparable_tree(2, engine.bpm_, memcomparable_KP);
+    // Prepare data, negative keys as well
+    const int n = 20000;
+    vector<GenericKey *> keys;
+    for (int i = 0; i < n; i++) {
+        GenericKey *key = KP.InitKey();
+        std::vector<Field> fields{Field(TypeId::kTypeInt, i - n / 2)};
+        KP.SerializeFromKey(key, Row(fields), table_schema);
+        keys.push_back(key);
+    }
+    vector<GenericKey *> sorted_keys(keys);
+    ShuffleArray(keys);
+    for (auto current_tree : {&small_tree, &tree}) {
+        for (int i = 0; i < n; i++) {
+            ASSERT_TRUE(current_tree->Insert(keys[i], RowId(KeyManager::GetInt32(keys[i]))));
+        }
+        ASSERT_TRUE(current_tree->Check());
+        // Search keys
+        for (int i = 0; i < n; i++) {
+            vector<RowId> ans;
+            ASSERT_TRUE(current_tree->GetValue(keys[i], ans));
+            ASSERT_EQ(RowId(KeyManager::GetInt32(keys[i])), ans[0]);
+        }
+        // Scan in key order
+        int i = 0;
+        for (auto iter = current_tree->Begin(); iter != current_tree->End(); ++iter, i++) {
+            ASSERT_EQ(0, KP.CompareKeys((*iter).first, sorted_keys[i]));
+        }
+        ASSERT_EQ(n, i);
+        i = n / 4;
+        for (auto iter = current_tree->Begin(sorted_keys[n / 4]); iter != current_tree->End(); ++iter, i++) {
+            ASSERT_EQ(0, KP.CompareKeys((*iter).first, sorted_keys[i]));
+        }
+        ASSERT_EQ(n, i);
+        // Delete half keys
+        for (int i = 0; i < n / 2; i++) {
+            current_tree->Remove(keys[i]);
+        }
+        vector<RowId> ans;
+        for (int i = 0; i < n / 2; i++) {
+            ASSERT_FALSE(current_tree->GetValue(keys[i], ans));
+        }
+        for (int i = n / 2; i < n; i++) {
+            ASSERT_TRUE(current_tree->GetValue(keys[i], ans));
+        }
+        ASSERT_TRUE(current_tree->Check());
+    }
+    // Row decoding
+    Row row(INVALID_ROWID);
+    KP.DeserializeToKey(sorted_keys[0], row, table_schema);
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, -n / 2)));
+    // Fanout
+    GenericKey *memcomparable_key = memcomparable_KP.InitKey();
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 0)};
+    memcomparable_KP.SerializeFromKey(memcomparable_key, Row(fields), table_schema);
+    memcomparable_tree.Insert(memcomparable_key, RowId(0));
+    auto leaf = reinterpret_cast<LeafPage *>(tree.FindLeafPage(nullptr, INVALID_PAGE_ID, true));
+    auto memcomparable_leaf =
+            reinterpret_cast<LeafPage *>(memcomparable_tree.FindLeafPage(nullptr, INVALID_PAGE_ID, true));
+    ASSERT_GE(leaf->GetMaxSize(), 2 * memcomparable_leaf->GetMaxSize());
+    engine.bpm_->UnpinPage(leaf->GetPageId(), false);
+    engine.bpm_->UnpinPage(memcomparable_leaf->GetPageId(), false);
+    free(memcomparable_key);
+    for (auto key : keys) {
+        free(key);
+    }
+    remove(("./databases/" + db_name).c_str());
+}
+
+TEST(BPlusTreeTests, ConcurrentTest) {
+    // Init engine
+    DBStorageEngine engine(db_name);
+    std::vector<Column *> columns = {
+            new Column("int", TypeId::kTypeInt, 0, false, false),
+    };
+    Schema *table_schema = new Schema(columns);
+    KeyManager KP(table_schema, sizeof(int32_t), KeyEncoding::kInt32);
+    // small pages, so the threads keep splitting and merging pages under each other
+    BPlusTree tree(0, engine.bpm_, KP, 8, 8);
+    const int num_threads = 4;
+    const int n = 20000;
+    vector<GenericKey *> keys;
+    for (int i = 0; i < n; i++) {
+        GenericKey *key = KP.InitKey();
+        std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+        KP.SerializeFromKey(key, Row(fields), table_schema);
+        keys.push_back(key);
+    }
+    vector<GenericKey *> shuffled_keys(keys);
+    ShuffleArray(shuffled_keys);
+    // Insert concurrently, every thread its own slice of the keys
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = t; i < n; i += num_threads) {
+                tree.Insert(shuffled_keys[i], RowId(KeyManager::GetInt32(shuffled_keys[i])));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+    ASSERT_TRUE(tree.Check());
+    int i = 0;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter, i++) {
+        ASSERT_EQ(0, KP.CompareKeys((*iter).first, keys[i]));
+    }
+    ASSERT_EQ(n, i);
+    // Remove the odd keys while other threads look up the even ones
+    std::atomic<int> lookup_failures{0};
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = t; i < n; i += num_threads) {
+                int value = KeyManager::GetInt32(shuffled_keys[i]);
+                if (value % 2 == 1) {
+                    tree.Remove(shuffled_keys[i]);
+                    continue;
+                }
+                vector<RowId> ans;
+                if (!tree.GetValue(shuffled_keys[i], ans) || !(ans[0] == RowId(value))) {
+                    lookup_failures++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    ASSERT_EQ(0, lookup_failures.load());
+    ASSERT_TRUE(tree.Check());
+    vector<RowId> ans;
+    for (int i = 0; i < n; i++) {
+        ASSERT_EQ(i % 2 == 0, tree.GetValue(keys[i], ans));
+    }
+    i = 0;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter, i += 2) {
+        ASSERT_EQ(0, KP.CompareKeys((*iter).first, keys[i]));
+    }
+    ASSERT_EQ(n, i);
+    for (auto key : keys) {
+        free(key);
+    }
+    remove(("./databases/" + db_name).c_str());
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+    // Init engine
+    DBStorageEngine engine(db_name);
+    std::vector<Column *> columns = {
+            new Column("int", TypeId::kTypeInt, 0, false, false),
+    };
+    Schema *table_schema = new Schema(columns);
+    KeyManager KP(table_schema, 16);
+    const int n = 20000;
+    vector<Row> rows;
+    for (int i = 0; i < n; i++) {
+        std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+        rows.emplace_back(fields);
+    }
+    vector<int> order(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = i;
+    }
+    ShuffleArray(order);
+    vector<GenericKey *> keys;
+    for (int i = 0; i < n; i++) {
+        keys.push_back(KP.InitKey());
+        KP.SerializeFromKey(keys.back(), rows[i], table_schema);
+    }
+    // tiny pages build a deep tree, a fill factor under 1 leaves room in every page
+    struct Shape {
+        int leaf_max_size_;
+        int internal_max_size_;
+        double fill_factor_;
+    };
+    std::vector<Shape> shapes = {{4, 4, 1.0}, {4, 5, 0.5}, {UNDEFINED_SIZE, UNDEFINED_SIZE, 1.0},
+                                 {UNDEFINED_SIZE, UNDEFINED_SIZE, 0.7}};
+    for (size_t s = 0; s < shapes.size(); s++) {
+        BPlusTree tree(s, engine.bpm_, KP, shapes[s].leaf_max_size_, shapes[s].internal_max_size_);
+        // a small budget spills several runs, the repeated key keeps its first row id
+        KeySorter sorter(KP, 64 * 1024);
+        for (int i : order) {
+            sorter.Add(rows[i], table_schema, RowId(i));
+        }
+        sorter.Add(rows[0], table_schema, RowId(n));
+        sorter.Finish();
+        ASSERT_GT(sorter.GetRunCount(), 1);
+        ASSERT_TRUE(tree.BulkLoad(sorter, shapes[s].fill_factor_));
+        ASSERT_TRUE(tree.Check());
+        for (int i = 0; i < n; i++) {
+            vector<RowId> ans;
+            ASSERT_TRUE(tree.GetValue(keys[i], ans));
+            ASSERT_EQ(RowId(i), ans[0]);
+        }
+        int i = 0;
+        for (auto iter = tree.Begin(); iter != tree.End(); ++iter, i++) {
+            ASSERT_EQ(0, KP.CompareKeys((*iter).first, keys[i]));
+        }
+        ASSERT_EQ(n, i);
+        // Leaves are filled about as far as the fill factor says, the entries are spread evenly over the leaves
+        auto leaf = reinterpret_cast<LeafPage *>(tree.FindLeafPage(nullptr, INVALID_PAGE_ID, true));
+        ASSERT_GE(leaf->GetSize(), static_cast<int>(leaf->GetMaxSize() * shapes[s].fill_factor_ * 0.75));
+        ASSERT_LE(leaf->GetSize(), leaf->GetMaxSize());
+        engine.bpm_->UnpinPage(leaf->GetPageId(), false);
+        // Only an empty tree can be bulk loaded
+        KeySorter empty_sorter(KP);
+        empty_sorter.Finish();
+        ASSERT_FALSE(tree.BulkLoad(empty_sorter));
+        // The tree keeps working as if it was built by inserts
+        for (int i = 0; i < n; i += 2) {
+            tree.Remove(keys[i]);
+        }
+        for (int i = 0; i < n; i += 2) {
+            ASSERT_TRUE(tree.Insert(keys[i], RowId(i)));
+        }
+        for (int i = 1; i < n; i += 2) {
+            tree.Remove(keys[i]);
+        }
+        ASSERT_TRUE(tree.Check());
+        vector<RowId> ans;
+        for (int i = 0; i < n; i++) {
+            ASSERT_EQ(i % 2 == 0, tree.GetValue(keys[i], ans));
+        }
+        tree.Destroy();
+    }
+    for (auto key : keys) {
+        free(key);
+    }
+    remove(("./databases/" + db_name).c_str());
+}
@@ -0,0 +1,102 @@
+#include "page/table_page.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "record/field.h"
+#include "record/schema.h"
+
+TEST(PageTests, TablePageSlotReuseTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  const std::string name = "a name that takes up some room in the page";
+  auto make_row = [&](int id) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, id),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.length(), true)};
+    return Row(fields);
+  };
+  auto page = std::make_unique<TablePage>();
+  page->Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  std::vector<RowId> rids;
+  while (true) {
+    Row row = make_row(static_cast<int>(rids.size()));
+    if (!page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr)) {
+      break;
+    }
+    rids.push_back(row.GetRowId());
+  }
+  uint32_t full_count = page->GetTupleCount();
+  ASSERT_EQ(rids.size(), full_count);
+  ASSERT_GT(full_count, 10);
+  // deleting every other row only leaves dead space behind, nothing is moved yet
+  for (size_t i = 0; i < rids.size(); i += 2) {
+    ASSERT_TRUE(page->MarkDelete(rids[i], nullptr, nullptr, nullptr));
+    page->ApplyDelete(rids[i], nullptr, nullptr);
+  }
+  EXPECT_GT(page->GetDeadSpace(), 0);
+  for (size_t i = 1; i < rids.size(); i += 2) {
+    Row row(rids[i]);
+    ASSERT_TRUE(page->GetTuple(&row, schema.get(), nullptr, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, static_cast<int>(i))));
+  }
+  // new rows reuse the freed slots, compacting the page once the free space runs out
+  uint32_t reused = 0;
+  while (true) {
+    Row row = make_row(1000 + static_cast<int>(reused));
+    if (!page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr)) {
+      break;
+    }
+    EXPECT_EQ(0, row.GetRowId().GetSlotNum() % 2);
+    reused++;
+  }
+  EXPECT_EQ((rids.size() + 1) / 2, reused);
+  EXPECT_EQ(full_count, page->GetTupleCount());
+  EXPECT_EQ(0, page->GetDeadSpace());
+  for (size_t i = 1; i < rids.size(); i += 2) {
+    Row row(rids[i]);
+    ASSERT_TRUE(page->GetTuple(&row, schema.get(), nullptr, nullptr));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, static_cast<int>(i))));
+  }
+}
+
+TEST(PageTests, TablePageApplyDeleteAllTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto page = std::make_unique<TablePage>();
+  page->Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (int i = 0; i < 100; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_TRUE(page->InsertTuple(row, schema.get(), nullptr, nullptr, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  uint32_t max_insert_size = page->GetMaxInsertSize();
+  // the last 50 rows and every third of the rest are marked deleted, then removed in one pass
+  uint32_t marked = 0;
+  for (int i = 0; i < 100; i++) {
+    if (i >= 50 || i % 3 == 0) {
+      ASSERT_TRUE(page->MarkDelete(rids[i], nullptr, nullptr, nullptr));
+      marked++;
+    }
+  }
+  EXPECT_EQ(marked, page->ApplyDeleteAll(nullptr, nullptr));
+  EXPECT_EQ(0, page->GetDeadSpace());
+  // the free slots at the end of the slot array are given back
+  EXPECT_EQ(50, page->GetTupleCount());
+  EXPECT_GT(page->GetMaxInsertSize(), max_insert_size);
+  RowId rid;
+  uint32_t live = 0;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    Row row(rid);
+    ASSERT_TRUE(page->GetTuple(&row, schema.get(), nullptr, nullptr));
+    Field expected(TypeId::kTypeInt, static_cast<int>(rid.GetSlotNum()));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(expected));
+    EXPECT_NE(0, rid.GetSlotNum() % 3);
+    live++;
+  }
+  EXPECT_EQ(100 - marked, live);
+}
@@ -3,6 +3,8 @@
 #include <unordered_set>
 
 #include "gtest/gtest.h"
+#include "utils/utils.h"
+
 TEST(DiskManagerTest, BitMapPageTest) {
   const size_t size = 512;
   char buf[size];
@@ -80,3 +82,139 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   }
   remove(db_name.c_str());
 }
+
+TEST(DiskManagerTest, PositionalAndStreamBackendTest) {
+  std::string db_name = "disk_backend_test.db";
+  remove(db_name.c_str());
+  const int num_pages = 64;
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  {
+    DiskManager disk_mgr(db_name, DiskIOBackend::kPositional);
+    // reading past the end of the file yields a zeroed page
+    memset(buf, 1, PAGE_SIZE);
+    disk_mgr.ReadPage(num_pages, buf);
+    for (int i = 0; i < PAGE_SIZE; i++) {
+      ASSERT_EQ(0, buf[i]);
+    }
+    for (int i = 0; i < num_pages; i++) {
+      memset(data, 'a' + i % 26, PAGE_SIZE);
+      disk_mgr.WritePage(i, data);
+    }
+  }
+  DiskManager disk_mgr(db_name, DiskIOBackend::kStream);
+  for (int i = 0; i < num_pages; i++) {
+    memset(data, 'a' + i % 26, PAGE_SIZE);
+    disk_mgr.ReadPage(i, buf);
+    ASSERT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+  }
+  disk_mgr.Close();
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, BitmapWriteBackTest) {
+  std::string db_name = "disk_bitmap_test.db";
+  remove(db_name.c_str());
+  const uint32_t num_pages = DiskManager::BITMAP_SIZE + 100;
+  {
+    DiskManager disk_mgr(db_name);
+    for (uint32_t i = 0; i < num_pages; i++) {
+      ASSERT_EQ(i, disk_mgr.AllocatePage());
+    }
+    disk_mgr.DeAllocatePage(7);
+    disk_mgr.DeAllocatePage(DiskManager::BITMAP_SIZE + 3);
+  }
+  // the cached bitmaps must have reached the disk on close
+  DiskManager disk_mgr(db_name);
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr.GetMetaData());
+  EXPECT_EQ(num_pages - 2, meta_page->GetAllocatedPages());
+  EXPECT_EQ(2, meta_page->GetExtentNums());
+  for (uint32_t i = 0; i < num_pages; i++) {
+    EXPECT_EQ(i == 7 || i == DiskManager::BITMAP_SIZE + 3, disk_mgr.IsPageFree(i));
+  }
+  EXPECT_TRUE(disk_mgr.IsPageFree(num_pages));
+  // holes are reused before the file grows
+  std::unordered_set<page_id_t> reused{disk_mgr.AllocatePage(), disk_mgr.AllocatePage()};
+  EXPECT_EQ(1, reused.count(7));
+  EXPECT_EQ(1, reused.count(DiskManager::BITMAP_SIZE + 3));
+  disk_mgr.Close();
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncBatchIOTest) {
+  std::string db_name = "disk_async_test.db";
+  remove(db_name.c_str());
+  const int num_pages = 300;  // more than one ring of requests
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+  for (auto backend : {DiskIOBackend::kIoUring, DiskIOBackend::kPositional}) {
+    DiskManager disk_mgr(db_name, backend);
+    std::vector<DiskRequest> writes(num_pages);
+    std::vector<std::future<bool>> futures;
+    for (int i = 0; i < num_pages; i++) {
+      RandomUtils::RandomString(data[i].data(), PAGE_SIZE);
+      writes[i].is_write_ = true;
+      writes[i].page_id_ = i;
+      writes[i].data_ = data[i].data();
+      futures.push_back(writes[i].done_.get_future());
+    }
+    disk_mgr.SubmitRequests(writes);
+    for (auto &future : futures) {
+      ASSERT_TRUE(future.get());
+    }
+    std::vector<std::vector<char>> buf(num_pages + 1, std::vector<char>(PAGE_SIZE, 1));
+    std::vector<DiskRequest> reads(num_pages + 1);
+    std::atomic<int> callbacks{0};
+    futures.clear();
+    for (int i = 0; i <= num_pages; i++) {
+      reads[i].page_id_ = num_pages - i;
+      reads[i].data_ = buf[num_pages - i].data();
+      reads[i].callback_ = [&callbacks](bool) { callbacks++; };
+      futures.push_back(reads[i].done_.get_future());
+    }
+    disk_mgr.SubmitRequests(reads);
+    for (auto &future : futures) {
+      ASSERT_TRUE(future.get());
+    }
+    EXPECT_EQ(num_pages + 1, callbacks.load());
+    for (int i = 0; i < num_pages; i++) {
+      ASSERT_EQ(0, memcmp(data[i].data(), buf[i].data(), PAGE_SIZE));
+    }
+    // a page that was never written reads as zeros
+    for (int i = 0; i < PAGE_SIZE; i++) {
+      ASSERT_EQ(0, buf[num_pages][i]);
+    }
+    disk_mgr.Close();
+    remove(db_name.c_str());
+  }
+}
+
+TEST(DiskManagerTest, DeferredWriteTest) {
+  std::string db_name = "disk_deferred_test.db";
+  remove(db_name.c_str());
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  for (auto mode : {DurabilityMode::kStatement, DurabilityMode::kGroup}) {
+    DiskManager disk_mgr(db_name);
+    disk_mgr.SetDurabilityMode(mode, 3600 * 1000);
+    // the stream backend stats the file on every read, so it notices pages written by the other manager
+    DiskManager reader(db_name, DiskIOBackend::kStream);
+    for (int i = 10; i >= 0; i--) {
+      memset(data, 'a' + i, PAGE_SIZE);
+      disk_mgr.WritePage(i, data);
+      // the writer sees its own deferred page, the file does not have it yet
+      disk_mgr.ReadPage(i, buf);
+      ASSERT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+      reader.ReadPage(i, buf);
+      ASSERT_NE(0, memcmp(data, buf, PAGE_SIZE));
+    }
+    disk_mgr.Sync(mode == DurabilityMode::kGroup);
+    for (int i = 0; i <= 10; i++) {
+      memset(data, 'a' + i, PAGE_SIZE);
+      reader.ReadPage(i, buf);
+      ASSERT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+    }
+    reader.Close();
+    disk_mgr.Close();
+    remove(db_name.c_str());
+  }
+}
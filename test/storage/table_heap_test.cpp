@@ -81,6 +81,182 @@ TEST(TableHeapTest, TableHeapSampleTest) {
     }
 
     ASSERT_EQ(size, 0);
+    // nothing the heap did may leave a page pinned
+    ASSERT_TRUE(bpm_->CheckAllUnpinned());
     //delete file and free spaces
     remove(db_file_name.c_str());
 }
+
+/**
+ * A fresh heap of (id, name) rows with a name long enough that a page holds a few dozen of them. The database file,
+ * pool and heap are removed with it.
+ */
+class NamedRowHeap {
+public:
+    explicit NamedRowHeap(size_t pool_size = DEFAULT_BUFFER_POOL_SIZE) {
+        remove(db_file_name.c_str());
+        disk_mgr_ = new DiskManager(db_file_name);
+        bpm_ = new BufferPoolManager(pool_size, disk_mgr_);
+        std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                         new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+        schema_ = std::make_shared<Schema>(columns);
+        table_heap_ = TableHeap::Create(bpm_, schema_.get(), nullptr, nullptr, nullptr);
+    }
+
+    ~NamedRowHeap() {
+        delete table_heap_;
+        delete bpm_;
+        delete disk_mgr_;
+        remove(db_file_name.c_str());
+    }
+
+    static Row MakeRow(int id) {
+        static char name[] = "a name that takes up some room in the page";
+        Fields fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, name, strlen(name), true)};
+        return Row(fields);
+    }
+
+    /** Insert the rows with ids [0, count), their row ids in order */
+    std::vector<RowId> InsertRows(int count) {
+        std::vector<RowId> rids;
+        for (int i = 0; i < count; i++) {
+            Row row = MakeRow(i);
+            EXPECT_TRUE(table_heap_->InsertTuple(row, nullptr));
+            rids.push_back(row.GetRowId());
+        }
+        return rids;
+    }
+
+    DiskManager *disk_mgr_;
+    BufferPoolManager *bpm_;
+    std::shared_ptr<Schema> schema_;
+    TableHeap *table_heap_;
+};
+
+TEST(TableHeapTest, ReopenTest) {
+    NamedRowHeap heap;
+    TableHeap *table_heap = heap.table_heap_;
+    page_id_t last_page_id = heap.InsertRows(1000).back().GetPageId();
+    ASSERT_NE(table_heap->GetFirstPageId(), last_page_id);
+    // opening the heap again does not read its pages, the first insert finds the last page
+    TableHeap *reopened = TableHeap::Create(heap.bpm_, table_heap->GetFirstPageId(), heap.schema_.get(), nullptr,
+                                            nullptr, table_heap->GetFirstPageId());
+    Row row = NamedRowHeap::MakeRow(1000);
+    ASSERT_TRUE(reopened->InsertTuple(row, nullptr));
+    EXPECT_EQ(last_page_id, row.GetRowId().GetPageId());
+    uint32_t count = 0;
+    for (auto it = reopened->Begin(nullptr); it != reopened->End(); it++) {
+        count++;
+    }
+    EXPECT_EQ(1001, count);
+    ASSERT_TRUE(heap.bpm_->CheckAllUnpinned());
+    delete reopened;
+}
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+    NamedRowHeap heap;
+    TableHeap *table_heap = heap.table_heap_;
+    std::vector<RowId> rids = heap.InsertRows(1000);
+    page_id_t first_page_id = table_heap->GetFirstPageId();
+    ASSERT_NE(first_page_id, table_heap->GetLastPageId());
+    ASSERT_NE(INVALID_PAGE_ID, table_heap->GetFreeSpaceMapPageId());
+    // free a few rows of the first page, the next inserts go there instead of to the end of the heap
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(first_page_id, rids[i].GetPageId());
+        ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+        table_heap->ApplyDelete(rids[i], nullptr);
+    }
+    Row row = NamedRowHeap::MakeRow(1000);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    EXPECT_EQ(first_page_id, row.GetRowId().GetPageId());
+    // the map is kept on disk: a heap opened from the saved page ids still knows about the free space
+    TableHeap *reopened = TableHeap::Create(heap.bpm_, first_page_id, heap.schema_.get(), nullptr, nullptr,
+                                            table_heap->GetLastPageId(), table_heap->GetFreeSpaceMapPageId());
+    Row second_row = NamedRowHeap::MakeRow(1000);
+    ASSERT_TRUE(reopened->InsertTuple(second_row, nullptr));
+    EXPECT_EQ(first_page_id, second_row.GetRowId().GetPageId());
+    ASSERT_TRUE(heap.bpm_->CheckAllUnpinned());
+    delete reopened;
+}
+
+TEST(TableHeapTest, VacuumTest) {
+    NamedRowHeap heap;
+    TableHeap *table_heap = heap.table_heap_;
+    std::vector<RowId> rids = heap.InsertRows(2000);
+    auto count_pages = [&]() {
+        uint32_t pages = 0;
+        for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; pages++) {
+            ReadPageGuard guard = heap.bpm_->FetchPageRead(page_id);
+            page_id = guard.As<TablePage>()->GetNextPageId();
+        }
+        return pages;
+    };
+    uint32_t pages_before = count_pages();
+    // delete all rows but every hundredth, most pages end up empty
+    uint32_t deleted = 0;
+    for (size_t i = 0; i < rids.size(); i++) {
+        if (i % 100 != 0) {
+            ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+            deleted++;
+        }
+    }
+    EXPECT_EQ(deleted, table_heap->GetPendingDeletes());
+    uint32_t freed_pages = 0;
+    EXPECT_EQ(deleted, table_heap->Vacuum(nullptr, &freed_pages));
+    EXPECT_EQ(0, table_heap->GetPendingDeletes());
+    EXPECT_GT(freed_pages, 0);
+    EXPECT_EQ(pages_before - freed_pages, count_pages());
+    EXPECT_LE(count_pages(), 21);
+    // the survivors are still there, in order, and the chain is intact in both directions
+    int expected = 0;
+    for (auto it = table_heap->Begin(nullptr); it != table_heap->End(); it++) {
+        ASSERT_EQ(CmpBool::kTrue, it->GetField(0)->CompareEquals(Field(TypeId::kTypeInt, expected)));
+        expected += 100;
+    }
+    EXPECT_EQ(2000, expected);
+    page_id_t prev_page_id = INVALID_PAGE_ID;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+        ReadPageGuard guard = heap.bpm_->FetchPageRead(page_id);
+        EXPECT_EQ(prev_page_id, guard.As<TablePage>()->GetPrevPageId());
+        prev_page_id = page_id;
+        page_id = guard.As<TablePage>()->GetNextPageId();
+    }
+    EXPECT_EQ(prev_page_id, table_heap->GetLastPageId());
+    // the room is reused: inserting as many rows again does not grow the heap past its old size
+    heap.InsertRows(1980);
+    EXPECT_LE(count_pages(), pages_before);
+    ASSERT_TRUE(heap.bpm_->CheckAllUnpinned());
+}
+
+TEST(TableHeapTest, PartitionedScanTest) {
+    // a pool of a few hundred pages still scans the whole heap, with fewer workers
+    for (size_t pool_size : {static_cast<size_t>(DEFAULT_BUFFER_POOL_SIZE), static_cast<size_t>(64)}) {
+        NamedRowHeap heap(pool_size);
+        TableHeap *table_heap = heap.table_heap_;
+        const int row_nums = 20000;
+        std::vector<RowId> rids = heap.InsertRows(row_nums);
+        // deleted rows are skipped
+        for (int i = 0; i < row_nums; i += 7) {
+            ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+        }
+        const size_t num_workers = 16;
+        // every worker keeps its own rows, a worker is only ever called from its own thread
+        std::vector<std::vector<int>> seen(num_workers);
+        ASSERT_TRUE(table_heap->PartitionedScan(num_workers, [&](size_t worker, Row &row) {
+            ASSERT_LT(worker, num_workers);
+            int32_t id;
+            row.GetField(0)->SerializeTo(reinterpret_cast<char *>(&id));
+            seen[worker].push_back(id);
+        }));
+        std::vector<int> counts(row_nums, 0);
+        for (auto &ids : seen) {
+            for (int id : ids) {
+                counts[id]++;
+            }
+        }
+        for (int i = 0; i < row_nums; i++) {
+            ASSERT_EQ(i % 7 == 0 ? 0 : 1, counts[i]);
+        }
+        ASSERT_TRUE(heap.bpm_->CheckAllUnpinned());
+    }
+}